@@ -0,0 +1,1606 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "cd9list.h"
+#include "cd9simd.h"
+#include "cd9query.h"
+#include "cd9stringlist.h"
+
+/**
+ * @brief The number of node visits a benchmark of an operation that walks
+ *        the list should take. It is used to pick how many times the
+ *        operation is repeated, so every size takes about the same time.
+ */
+#define BENCH_WORK 10000000
+
+/**
+ * @brief The maximum number of times an operation is repeated.
+ */
+#define BENCH_MAX_OPS 100000
+
+/**
+ * @brief The default biggest size, see `make bench`.
+ */
+#define BENCH_DEFAULT_MAX_SIZE 100000
+
+/**
+ * @brief The biggest size used for the operations that are quadratic in
+ *        the length of the list, such as removing the elements one index at
+ *        a time, which walks the list from the head for every index.
+ */
+#define BENCH_QUADRATIC_LIMIT 20000
+
+/**
+ * @brief The state shared by all the benchmarks. `allocs` is the number of
+ *        calls to malloc, calloc and realloc made while the clock is running,
+ *        by the lists' allocator or anywhere else, see `bench_countAlloc`.
+ */
+typedef struct BenchState {
+    CD9Allocator allocator;
+    bool counting;
+    size_t allocs;
+    struct timespec start;
+    double elapsed;
+    int *values;
+    uint32_t seed;
+    long sink;
+} BenchState;
+
+/**
+ * @brief A benchmark, `run` should build whatever it needs, call
+ *        `bench_start` and `bench_stop` around the measured code and return
+ *        the number of operations it has measured. The time and the
+ *        allocations of every `bench_start`/`bench_stop` pair are added up.
+ */
+typedef struct Bench {
+    const char *name;
+    size_t (*run)(BenchState *state, size_t size);
+    size_t maxSize;
+} Bench;
+
+/**
+ * @brief The state of the benchmarks, it is read by the wrapped allocation
+ *        functions.
+ */
+BenchState *benchState = NULL;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *memory, size_t size);
+
+/**
+ * @brief The bench is linked with `-Wl,--wrap=malloc,...`, see `make bench`,
+ *        so the calls to malloc, calloc and realloc of the library go through
+ *        the `__wrap_` functions below. They can come from the thread of a
+ *        stream too, so the counter is updated atomically.
+ */
+void bench_countAlloc(void)
+{
+    if(benchState != NULL &&
+       __atomic_load_n(&benchState->counting, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(&benchState->allocs, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void *__wrap_malloc(size_t size)
+{
+    bench_countAlloc();
+
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    bench_countAlloc();
+
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *memory, size_t size)
+{
+    bench_countAlloc();
+
+    return __real_realloc(memory, size);
+}
+
+void *bench_alloc(void *ctx, size_t size)
+{
+    // The malloc is counted by `__wrap_malloc`.
+    return malloc(size);
+}
+
+void bench_free(void *ctx, void *memory, size_t size)
+{
+    free(memory);
+}
+
+uint32_t bench_random(BenchState *state)
+{
+    state->seed ^= state->seed << 13;
+    state->seed ^= state->seed >> 17;
+    state->seed ^= state->seed << 5;
+
+    return state->seed;
+}
+
+void bench_start(BenchState *state)
+{
+    __atomic_store_n(&state->counting, true, __ATOMIC_RELAXED);
+    clock_gettime(CLOCK_MONOTONIC, &state->start);
+}
+
+void bench_stop(BenchState *state)
+{
+    struct timespec stop;
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    __atomic_store_n(&state->counting, false, __ATOMIC_RELAXED);
+    state->elapsed += (stop.tv_sec - state->start.tv_sec) +
+                      (stop.tv_nsec - state->start.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief The number of times an operation that walks the list is repeated.
+ *        The operations that change the length of the list are run in
+ *        rounds of at most `size` operations on a fresh list, so the length
+ *        never drifts too far from `size`.
+ */
+size_t bench_repeat(size_t size)
+{
+    size_t ops = BENCH_WORK / size;
+
+    if(ops < 1) {
+        return 1;
+    }
+
+    return (ops > BENCH_MAX_OPS) ? BENCH_MAX_OPS : ops;
+}
+
+/**
+ * @brief The number of operations in the next round, see `bench_repeat`.
+ */
+size_t bench_round(size_t size, size_t done, size_t ops)
+{
+    return (ops - done < size) ? ops - done : size;
+}
+
+/**
+ * @brief Builds a list of `size` elements. The list is built from the end,
+ *        with `prepend`, so it takes linear time even for the big sizes.
+ */
+CD9List *bench_createList(BenchState *state, size_t size, bool copies)
+{
+    CD9List *list = cd9list_createListWithAllocator(&state->allocator);
+
+    for(size_t i = size; i-- > 0;) {
+        if(copies) {
+            list->prependCopy(list, &state->values[i], sizeof(int));
+        }
+        else {
+            list->prepend(list, &state->values[i]);
+        }
+    }
+
+    return list;
+}
+
+/**
+ * @brief Builds a list of `size` copies whose nodes are linked in a random
+ *        order, so walking the list jumps all over the heap, like a list
+ *        that was built by many inserts and removes.
+ */
+CD9List *bench_createScatteredList(BenchState *state, size_t size)
+{
+    CD9List *list   = bench_createList(state, size, true);
+    CD9Node **nodes = malloc(size * sizeof(CD9Node *));
+
+    CD9FOREACH_(list, node, index) {
+        nodes[index] = node;
+    }
+
+    for(size_t i = size - 1; i > 0; i--) {
+        size_t j      = bench_random(state) % (i + 1);
+        CD9Node *node = nodes[i];
+
+        nodes[i] = nodes[j];
+        nodes[j] = node;
+    }
+
+    for(size_t i = 0; i + 1 < size; i++) {
+        nodes[i]->next = nodes[i + 1];
+    }
+
+    nodes[size - 1]->next = NULL;
+    list->nodes           = nodes[0];
+
+    free(nodes);
+
+    return list;
+}
+
+bool bench_addressCmp(const void *data, const void *toFind, size_t size)
+{
+    return data == toFind;
+}
+
+int bench_intCmp(const void *a, const void *b)
+{
+    int first  = *(const int *)a;
+    int second = *(const int *)b;
+
+    return (first > second) - (first < second);
+}
+
+size_t bench_append(BenchState *state, size_t size)
+{
+    size_t ops = bench_repeat(size);
+
+    for(size_t done = 0, round; done < ops; done += round) {
+        CD9List *list = bench_createList(state, size, false);
+        round         = bench_round(size, done, ops);
+
+        bench_start(state);
+        for(size_t i = 0; i < round; i++) {
+            list->append(list, &state->values[i]);
+        }
+        bench_stop(state);
+
+        cd9list_deleteList(list);
+    }
+
+    return ops;
+}
+
+size_t bench_prepend(BenchState *state, size_t size)
+{
+    size_t ops = (size < BENCH_MAX_OPS) ? BENCH_MAX_OPS : size;
+
+    for(size_t done = 0, round; done < ops; done += round) {
+        CD9List *list = cd9list_createListWithAllocator(&state->allocator);
+        round         = bench_round(size, done, ops);
+
+        bench_start(state);
+        for(size_t i = 0; i < round; i++) {
+            list->prepend(list, &state->values[i]);
+        }
+        bench_stop(state);
+
+        cd9list_deleteList(list);
+    }
+
+    return ops;
+}
+
+size_t bench_insert(BenchState *state, size_t size)
+{
+    size_t ops = bench_repeat(size);
+
+    for(size_t done = 0, round; done < ops; done += round) {
+        CD9List *list = bench_createList(state, size, false);
+        round         = bench_round(size, done, ops);
+
+        bench_start(state);
+        for(size_t i = 0; i < round; i++) {
+            list->insert(list, list->length / 2, &state->values[i]);
+        }
+        bench_stop(state);
+
+        cd9list_deleteList(list);
+    }
+
+    return ops;
+}
+
+size_t bench_get(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createList(state, size, false);
+    size_t ops    = bench_repeat(size);
+    int sum       = 0;
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        sum += *(int *)list->get(list, bench_random(state) % size);
+    }
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+
+    // Keeps the compiler from dropping the loop.
+    if(sum == 42) {
+        fprintf(stderr, " ");
+    }
+
+    return ops;
+}
+
+size_t bench_find(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createList(state, size, false);
+    size_t ops    = bench_repeat(size);
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        size_t index = bench_random(state) % size;
+        list->find(list, &state->values[index], bench_addressCmp);
+    }
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+
+    return ops;
+}
+
+size_t bench_findScattered(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createScatteredList(state, size);
+    size_t ops    = bench_repeat(size);
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        int value = state->values[bench_random(state) % size];
+        list->findByValue(list, &value);
+    }
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+
+    return ops;
+}
+
+/**
+ * @brief Sums the elements of a scattered list, so the time of the walk is
+ *        not hidden by a callback. With `compact` the list is compacted
+ *        first, see `cd9list_compact`. The sum is returned through `sink`, so
+ *        the loop is not optimized away.
+ */
+size_t bench_scan(BenchState *state, size_t size, bool prefetch,
+                  bool compact)
+{
+    CD9List *list = bench_createScatteredList(state, size);
+    size_t ops    = bench_repeat(size);
+    long sum      = 0;
+
+    if(compact) {
+        cd9list_compact(list);
+    }
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        if(prefetch) {
+            CD9FOREACH_PREFETCH(list, value) {
+                sum += *(int *)value;
+            }
+        }
+        else {
+            CD9FOREACH(list, value) {
+                sum += *(int *)value;
+            }
+        }
+    }
+    bench_stop(state);
+
+    state->sink += sum;
+    cd9list_deleteList(list);
+
+    return ops;
+}
+
+size_t bench_scanScattered(BenchState *state, size_t size)
+{
+    return bench_scan(state, size, false, false);
+}
+
+size_t bench_scanScatteredPrefetch(BenchState *state, size_t size)
+{
+    return bench_scan(state, size, true, false);
+}
+
+size_t bench_scanCompacted(BenchState *state, size_t size)
+{
+    return bench_scan(state, size, false, true);
+}
+
+/**
+ * @brief Looks for a missing value in `size` ints stored next to each
+ *        other, so every element is compared by the vectorized kernel.
+ */
+size_t bench_simdFind(BenchState *state, size_t size)
+{
+    size_t ops = bench_repeat(size);
+    int key    = -1;
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        state->sink += cd9simd_find(state->values, size, sizeof(int), &key);
+    }
+    bench_stop(state);
+
+    return ops;
+}
+
+size_t bench_findByValue(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createList(state, size, true);
+    size_t ops    = bench_repeat(size);
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        size_t index = bench_random(state) % size;
+        list->findByValue(list, &state->values[index]);
+    }
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+
+    return ops;
+}
+
+bool bench_intEqual(const void *data, const void *toFind, size_t size)
+{
+    return *(const int *)data == *(const int *)toFind;
+}
+
+/**
+ * @brief A block predicate for ints. The loads of the block don't depend on
+ *        each other, so they are all issued before the first one returns,
+ *        and the comparisons are done by a loop the compiler vectorizes.
+ */
+void bench_intEqualBatch(const void *const *items,
+                         const size_t      *sizes,
+                         size_t            n,
+                         const void        *key,
+                         uint8_t           *matches)
+{
+    int values[CD9LIST_FIND_BATCH];
+    int value = *(const int *)key;
+
+    for(size_t i = 0; i < n; i++) {
+        values[i] = *(const int *)items[i];
+    }
+
+    for(size_t i = 0; i < n; i++) {
+        matches[i] = (values[i] == value) & (sizes[i] == sizeof(int));
+    }
+}
+
+/**
+ * @brief Looks for a copied int with a predicate called for every node, or
+ *        once per batch of nodes when `batched` is `true`. The nodes are
+ *        linked in a random order when `scattered` is `true`.
+ */
+size_t bench_findPredicate(BenchState *state,
+                           size_t     size,
+                           bool       batched,
+                           bool       scattered)
+{
+    CD9List *list = scattered ? bench_createScatteredList(state, size) :
+                                bench_createList(state, size, true);
+    size_t ops    = bench_repeat(size);
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        const int *key = &state->values[bench_random(state) % size];
+
+        state->sink += batched ?
+            cd9list_findBatched(list, key, bench_intEqualBatch) :
+            list->find(list, key, bench_intEqual);
+    }
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+
+    return ops;
+}
+
+size_t bench_findPredicateSingle(BenchState *state, size_t size)
+{
+    return bench_findPredicate(state, size, false, false);
+}
+
+size_t bench_findPredicateBatched(BenchState *state, size_t size)
+{
+    return bench_findPredicate(state, size, true, false);
+}
+
+size_t bench_findPredicateScattered(BenchState *state, size_t size)
+{
+    return bench_findPredicate(state, size, false, true);
+}
+
+size_t bench_findBatchedScattered(BenchState *state, size_t size)
+{
+    return bench_findPredicate(state, size, true, true);
+}
+
+/**
+ * @brief The size of the elements of the `findByValue_large` benchmarks.
+ */
+#define BENCH_LARGE_SIZE 256
+
+/**
+ * @brief Looks for values that are not in a list of large copies, which
+ *        differ only in their last bytes. `hashing` turns on
+ *        `cd9list_setHashing`.
+ */
+size_t bench_findLarge(BenchState *state, size_t size, bool hashing)
+{
+    CD9List *list = cd9list_createListWithAllocator(&state->allocator);
+    size_t ops    = bench_repeat(size);
+    unsigned char payload[BENCH_LARGE_SIZE];
+
+    cd9list_setHashing(list, hashing);
+    memset(payload, 'x', sizeof(payload));
+
+    for(size_t i = size; i-- > 0;) {
+        memcpy(payload + BENCH_LARGE_SIZE - sizeof(int), &state->values[i],
+               sizeof(int));
+        list->prependCopy(list, payload, sizeof(payload));
+    }
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        int missing = -(int)(bench_random(state) % size) - 1;
+
+        memcpy(payload + BENCH_LARGE_SIZE - sizeof(int), &missing,
+               sizeof(int));
+        state->sink += list->findByValue(list, payload);
+    }
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+
+    return ops;
+}
+
+size_t bench_findLargeMemcmp(BenchState *state, size_t size)
+{
+    return bench_findLarge(state, size, false);
+}
+
+size_t bench_findLargeHashed(BenchState *state, size_t size)
+{
+    return bench_findLarge(state, size, true);
+}
+
+size_t bench_remove(BenchState *state, size_t size)
+{
+    size_t ops = bench_repeat(size);
+
+    for(size_t done = 0, round; done < ops; done += round) {
+        CD9List *list = bench_createList(state, 2 * size, true);
+        round         = bench_round(size, done, ops);
+
+        bench_start(state);
+        for(size_t i = 0; i < round; i++) {
+            list->remove(list, list->length / 2);
+        }
+        bench_stop(state);
+
+        cd9list_deleteList(list);
+    }
+
+    return ops;
+}
+
+/**
+ * @brief Removes a tenth of the elements, spread over the list, with
+ *        `remove` or with `cd9list_removeIndices` when `batched` is `true`.
+ */
+size_t bench_removeScattered(BenchState *state, size_t size, bool batched)
+{
+    CD9List *list   = bench_createList(state, size, true);
+    size_t count    = (size < 10) ? 1 : size / 10;
+    size_t *indices = malloc(count * sizeof(size_t));
+
+    for(size_t i = 0; i < count; i++) {
+        indices[i] = bench_random(state) % size;
+    }
+
+    bench_start(state);
+    if(batched) {
+        state->sink += cd9list_removeIndices(list, indices, count, NULL);
+    }
+    else {
+        // The list shrinks, so the indices are kept in range.
+        for(size_t i = 0; i < count; i++) {
+            state->sink += list->remove(list, indices[i] % list->length);
+        }
+    }
+    bench_stop(state);
+
+    free(indices);
+    cd9list_deleteList(list);
+
+    return 1;
+}
+
+size_t bench_removeLoop(BenchState *state, size_t size)
+{
+    return bench_removeScattered(state, size, false);
+}
+
+size_t bench_removeIndices(BenchState *state, size_t size)
+{
+    return bench_removeScattered(state, size, true);
+}
+
+size_t bench_pop(BenchState *state, size_t size)
+{
+    size_t ops = bench_repeat(size);
+
+    for(size_t done = 0, round; done < ops; done += round) {
+        CD9List *list = bench_createList(state, 2 * size, false);
+        round         = bench_round(size, done, ops);
+
+        bench_start(state);
+        for(size_t i = 0; i < round; i++) {
+            list->pop(list);
+        }
+        bench_stop(state);
+
+        cd9list_deleteList(list);
+    }
+
+    return ops;
+}
+
+size_t bench_popleft(BenchState *state, size_t size)
+{
+    size_t ops = (size < BENCH_MAX_OPS) ? BENCH_MAX_OPS : size;
+
+    for(size_t done = 0, round; done < ops; done += round) {
+        CD9List *list = bench_createList(state, size, true);
+        round         = bench_round(size, done, ops);
+
+        bench_start(state);
+        for(size_t i = 0; i < round; i++) {
+            free(list->popleft(list));
+        }
+        bench_stop(state);
+
+        cd9list_deleteList(list);
+    }
+
+    return ops;
+}
+
+/**
+ * @brief The size of the messages of the hand-off benchmarks.
+ */
+#define BENCH_MESSAGE_SIZE 64
+
+/**
+ * @brief Hands messages over through a list: every message is built in a
+ *        malloc'd buffer, added to the list and taken back. With `owned`
+ *        the buffers move in and out of the list without being copied. The
+ *        list uses `malloc`, since only such lists can adopt the buffers.
+ */
+size_t bench_handOff(BenchState *state, size_t size, bool owned)
+{
+    CD9List *list = cd9list_createList();
+    size_t ops    = BENCH_MAX_OPS;
+
+    for(size_t i = 0; i < size; i++) {
+        list->prependCopy(list, &state->values[i], sizeof(int));
+    }
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        char *message = malloc(BENCH_MESSAGE_SIZE);
+
+        memset(message, (int)i, BENCH_MESSAGE_SIZE);
+
+        if(owned) {
+            cd9list_prependOwned(list, message, BENCH_MESSAGE_SIZE);
+            message = cd9list_popleftOwned(list, NULL);
+        }
+        else {
+            list->prependCopy(list, message, BENCH_MESSAGE_SIZE);
+            free(message);
+            message = list->popleft(list);
+        }
+
+        state->sink += message[0];
+        free(message);
+    }
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+
+    return ops;
+}
+
+size_t bench_handOffCopy(BenchState *state, size_t size)
+{
+    return bench_handOff(state, size, false);
+}
+
+size_t bench_handOffOwned(BenchState *state, size_t size)
+{
+    return bench_handOff(state, size, true);
+}
+
+/**
+ * @brief Helper used by the sort benchmarks. `order` is `0` for random
+ *        input, `1` for sorted input and `-1` for reversed input.
+ */
+size_t bench_sortInput(BenchState *state, size_t size, int order)
+{
+    int *input    = malloc(size * sizeof(int));
+    CD9List *list = cd9list_createListWithAllocator(&state->allocator);
+
+    for(size_t i = 0; i < size; i++) {
+        if(order == 0) {
+            input[i] = bench_random(state);
+        }
+        else {
+            input[i] = (order > 0) ? (int)i : (int)(size - i);
+        }
+    }
+
+    for(size_t i = size; i-- > 0;) {
+        list->prepend(list, &input[i]);
+    }
+
+    bench_start(state);
+    list->sort(list, bench_intCmp);
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+    free(input);
+
+    return 1;
+}
+
+size_t bench_sortRandom(BenchState *state, size_t size)
+{
+    return bench_sortInput(state, size, 0);
+}
+
+size_t bench_sortSorted(BenchState *state, size_t size)
+{
+    return bench_sortInput(state, size, 1);
+}
+
+size_t bench_sortReversed(BenchState *state, size_t size)
+{
+    return bench_sortInput(state, size, -1);
+}
+
+/**
+ * @brief Every token of the `tokens` benchmarks appears about this many
+ *        times in the list.
+ */
+#define BENCH_TOKEN_REPEAT 4
+
+int bench_strcmp(const void *a, const void *b)
+{
+    return strcmp(a, b);
+}
+
+bool bench_strEqual(const void *data, const void *toFind, size_t size)
+{
+    return !strcmp(data, toFind);
+}
+
+/**
+ * @brief Writes a random token of a list of `size` tokens in `buffer`. The
+ *        tokens are words of 3 to 10 letters, the same id always gives the
+ *        same word.
+ */
+void bench_token(BenchState *state, size_t size, char *buffer)
+{
+    uint32_t id     = bench_random(state) % (size / BENCH_TOKEN_REPEAT + 1);
+    uint32_t letter = id * 2654435761u + 12345u;
+    size_t length   = 3 + id % 8;
+
+    for(size_t i = 0; i < length; i++) {
+        buffer[i] = 'a' + letter % 26;
+        letter    = letter * 1103515245u + 12345u + id;
+    }
+
+    buffer[length] = '\0';
+}
+
+/**
+ * @brief Builds a list of `size` tokens, like the output of a tokenizer.
+ *        The copies are made with `prependCopy`, the way token lists are
+ *        built today, or by a string list that interns them.
+ */
+void *bench_createTokens(BenchState *state, size_t size, bool strings)
+{
+    CD9StringList *stringList = strings ? cd9stringlist_createList(true) :
+                                          NULL;
+    CD9List *list             = strings ? NULL :
+        cd9list_createListWithAllocator(&state->allocator);
+    char token[32];
+
+    for(size_t i = 0; i < size; i++) {
+        bench_token(state, size, token);
+
+        if(strings) {
+            stringList->append(stringList, token);
+        }
+        else {
+            list->prependCopy(list, token, strlen(token) + 1);
+        }
+    }
+
+    return strings ? (void *)stringList : (void *)list;
+}
+
+/**
+ * @brief Builds a list of tokens and sorts it.
+ */
+size_t bench_tokensSort(BenchState *state, size_t size, bool strings)
+{
+    bench_start(state);
+    void *tokens = bench_createTokens(state, size, strings);
+
+    if(strings) {
+        CD9StringList *list = tokens;
+
+        list->sort(list);
+        cd9stringlist_deleteList(list);
+    }
+    else {
+        CD9List *list = tokens;
+
+        list->sort(list, bench_strcmp);
+        cd9list_deleteList(list);
+    }
+    bench_stop(state);
+
+    return 1;
+}
+
+size_t bench_tokensSortList(BenchState *state, size_t size)
+{
+    return bench_tokensSort(state, size, false);
+}
+
+size_t bench_tokensSortStrings(BenchState *state, size_t size)
+{
+    return bench_tokensSort(state, size, true);
+}
+
+/**
+ * @brief Looks for random tokens, half of them are not in the list.
+ */
+size_t bench_tokensFind(BenchState *state, size_t size, bool strings)
+{
+    void *tokens = bench_createTokens(state, size, strings);
+    size_t ops   = bench_repeat(size);
+    char token[32];
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        bench_token(state, 2 * size, token);
+
+        if(strings) {
+            CD9StringList *list = tokens;
+            state->sink        += list->find(list, token);
+        }
+        else {
+            CD9List *list = tokens;
+            state->sink  += list->find(list, token, bench_strEqual);
+        }
+    }
+    bench_stop(state);
+
+    if(strings) {
+        cd9stringlist_deleteList(tokens);
+    }
+    else {
+        cd9list_deleteList(tokens);
+    }
+
+    return ops;
+}
+
+size_t bench_tokensFindList(BenchState *state, size_t size)
+{
+    return bench_tokensFind(state, size, false);
+}
+
+size_t bench_tokensFindStrings(BenchState *state, size_t size)
+{
+    return bench_tokensFind(state, size, true);
+}
+
+/**
+ * @brief The number of elements kept by the `topK` benchmark.
+ */
+#define BENCH_TOP_K 100
+
+/**
+ * @brief Builds a list that references `size` random ints, for the
+ *        selection benchmarks. The ints are returned in `input`.
+ */
+CD9List *bench_createRandomList(BenchState *state, size_t size, int **input)
+{
+    CD9List *list = cd9list_createListWithAllocator(&state->allocator);
+
+    *input = malloc(size * sizeof(int));
+
+    for(size_t i = size; i-- > 0;) {
+        (*input)[i] = bench_random(state);
+        list->prepend(list, &(*input)[i]);
+    }
+
+    return list;
+}
+
+size_t bench_topK(BenchState *state, size_t size)
+{
+    int *input;
+    CD9List *list = bench_createRandomList(state, size, &input);
+
+    bench_start(state);
+    CD9List *top = cd9list_topK(list, BENCH_TOP_K, bench_intCmp);
+    bench_stop(state);
+
+    cd9list_deleteList(top);
+    cd9list_deleteList(list);
+    free(input);
+
+    return 1;
+}
+
+size_t bench_nthElement(BenchState *state, size_t size)
+{
+    int *input;
+    CD9List *list = bench_createRandomList(state, size, &input);
+
+    bench_start(state);
+    state->sink += *(int *)cd9list_nthElement(list, size / 2, bench_intCmp);
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+    free(input);
+
+    return 1;
+}
+
+/**
+ * @brief The number of sorted shards merged by the merge benchmarks.
+ */
+#define BENCH_SHARDS 16
+
+/**
+ * @brief Splits the values `0` to `size - 1` into `count` sorted lists of
+ *        copies, the value `i` goes to the list `i % count`.
+ */
+void bench_createShards(BenchState *state,
+                        size_t     size,
+                        CD9List    **shards,
+                        size_t     count)
+{
+    for(size_t s = 0; s < count; s++) {
+        shards[s] = cd9list_createListWithAllocator(&state->allocator);
+    }
+
+    for(size_t i = size; i-- > 0;) {
+        int value = (int)i;
+
+        shards[i % count]->prependCopy(shards[i % count], &value,
+                                       sizeof(int));
+    }
+}
+
+/**
+ * @brief The way the shards were merged before `cd9list_mergeK`: concat
+ *        them, then sort the result.
+ */
+size_t bench_mergeConcatSort(BenchState *state, size_t size)
+{
+    CD9List *shards[BENCH_SHARDS];
+
+    bench_createShards(state, size, shards, BENCH_SHARDS);
+
+    bench_start(state);
+    CD9List *result = shards[0]->copy(shards[0]);
+
+    for(size_t s = 1; s < BENCH_SHARDS; s++) {
+        CD9List *next = cd9list_concat(result, shards[s]);
+
+        cd9list_deleteList(result);
+        result = next;
+    }
+
+    result->sort(result, bench_intCmp);
+    bench_stop(state);
+
+    cd9list_deleteList(result);
+
+    for(size_t s = 0; s < BENCH_SHARDS; s++) {
+        cd9list_deleteList(shards[s]);
+    }
+
+    return 1;
+}
+
+size_t bench_mergeSorted(BenchState *state, size_t size)
+{
+    CD9List *shards[2];
+
+    bench_createShards(state, size, shards, 2);
+
+    bench_start(state);
+    cd9list_mergeSorted(shards[0], shards[1], bench_intCmp);
+    bench_stop(state);
+
+    cd9list_deleteList(shards[0]);
+    cd9list_deleteList(shards[1]);
+
+    return 1;
+}
+
+size_t bench_mergeK(BenchState *state, size_t size)
+{
+    CD9List *shards[BENCH_SHARDS];
+
+    bench_createShards(state, size, shards, BENCH_SHARDS);
+
+    bench_start(state);
+    cd9list_mergeK(shards, BENCH_SHARDS, bench_intCmp);
+    bench_stop(state);
+
+    for(size_t s = 0; s < BENCH_SHARDS; s++) {
+        cd9list_deleteList(shards[s]);
+    }
+
+    return 1;
+}
+
+size_t bench_filter(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createList(state, size, false);
+
+    bench_start(state);
+    CD9List *filtered = list->filter(list, &state->values[0],
+                                     bench_addressCmp);
+    bench_stop(state);
+
+    cd9list_deleteList(filtered);
+    cd9list_deleteList(list);
+
+    return 1;
+}
+
+bool bench_oddCmp(const void *data, const void *toFind, size_t size)
+{
+    return *(const int *)data % 2 != 0;
+}
+
+/**
+ * @brief Drops the odd elements and one value, then takes the second half
+ *        of the rest, with a list built at every step.
+ */
+size_t bench_chainEager(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createList(state, size, true);
+
+    bench_start(state);
+    CD9List *even     = list->filter(list, NULL, bench_oddCmp);
+    CD9List *filtered = even->filterByValue(even, &state->values[0]);
+    CD9List *result   = filtered->slice(filtered, filtered->length / 2, 0, 1);
+    bench_stop(state);
+
+    cd9list_deleteList(result);
+    cd9list_deleteList(filtered);
+    cd9list_deleteList(even);
+    cd9list_deleteList(list);
+
+    return 1;
+}
+
+/**
+ * @brief The same steps as `bench_chainEager`, run by a single query.
+ */
+size_t bench_chainQuery(BenchState *state, size_t size)
+{
+    CD9List *list   = bench_createList(state, size, true);
+    CD9Query *query = cd9query_create(list);
+
+    bench_start(state);
+    query->filter(query, NULL, bench_oddCmp)
+         ->filterByValue(query, &state->values[0])
+         ->skip(query, (size / 2 - 1) / 2);
+    CD9List *result = query->collect(query);
+    bench_stop(state);
+
+    cd9list_deleteList(result);
+    cd9query_delete(query);
+    cd9list_deleteList(list);
+
+    return 1;
+}
+
+size_t bench_filterBySet(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createList(state, size, true);
+    CD9List *set  = bench_createList(state, (size < 8) ? size : 8, true);
+
+    bench_start(state);
+    CD9List *filtered = list->filterBySet(list, set);
+    bench_stop(state);
+
+    cd9list_deleteList(filtered);
+    cd9list_deleteList(set);
+    cd9list_deleteList(list);
+
+    return 1;
+}
+
+/**
+ * @brief Builds a list of `size` copies where every value shows up about 4
+ *        times, for `cd9list_unique` and `cd9list_countDistinct`.
+ */
+CD9List *bench_createDuplicatesList(BenchState *state, size_t size)
+{
+    CD9List *list   = cd9list_createListWithAllocator(&state->allocator);
+    size_t distinct = (size < 4) ? 1 : size / 4;
+
+    for(size_t i = size; i-- > 0;) {
+        list->prependCopy(list, &state->values[bench_random(state) % distinct],
+                          sizeof(int));
+    }
+
+    return list;
+}
+
+size_t bench_unique(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createDuplicatesList(state, size);
+
+    bench_start(state);
+    state->sink += cd9list_unique(list, NULL, NULL);
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+
+    return 1;
+}
+
+size_t bench_countDistinct(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createDuplicatesList(state, size);
+
+    bench_start(state);
+    state->sink += cd9list_countDistinct(list, NULL, NULL);
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+
+    return 1;
+}
+
+/**
+ * @brief The number of elements of a chunk in the chunking benchmarks.
+ */
+#define BENCH_CHUNK 1000
+
+/**
+ * @brief Cuts a list into chunks of \ref BENCH_CHUNK elements with `slice`,
+ *        then deletes the list, the way it was done before `splitAt`.
+ */
+size_t bench_sliceChunks(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createList(state, size, true);
+
+    bench_start(state);
+    for(size_t start = 0; start < size; start += BENCH_CHUNK) {
+        size_t stop    = (start + BENCH_CHUNK < size) ? start + BENCH_CHUNK :
+                                                        size;
+        CD9List *chunk = list->slice(list, start, stop, 1);
+
+        state->sink += chunk->length;
+        cd9list_deleteList(chunk);
+    }
+
+    cd9list_deleteList(list);
+    bench_stop(state);
+
+    return 1;
+}
+
+size_t bench_splitChunks(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createList(state, size, true);
+
+    bench_start(state);
+    while(list->length > 0) {
+        CD9List *rest = cd9list_splitAt(list, BENCH_CHUNK);
+
+        state->sink += list->length;
+        cd9list_deleteList(list);
+        list = rest;
+    }
+
+    cd9list_deleteList(list);
+    bench_stop(state);
+
+    return 1;
+}
+
+/**
+ * @brief The number of elements of the lists of the `small_lists`
+ *        benchmarks.
+ */
+#define BENCH_SMALL_LENGTH 3
+
+/**
+ * @brief Builds and deletes many lists of a few elements, like per-key
+ *        attribute lists. `small` uses `cd9list_createSmallList`.
+ */
+size_t bench_smallLists(BenchState *state, size_t size, bool small)
+{
+    size_t ops = BENCH_MAX_OPS;
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        CD9List *list = small ?
+            cd9list_createSmallListWithAllocator(&state->allocator) :
+            cd9list_createListWithAllocator(&state->allocator);
+
+        for(size_t j = 0; j < BENCH_SMALL_LENGTH; j++) {
+            list->prependCopy(list, &state->values[j], sizeof(int));
+        }
+
+        state->sink += list->findByValue(list, &state->values[0]);
+        cd9list_deleteList(list);
+    }
+    bench_stop(state);
+
+    return ops;
+}
+
+size_t bench_smallListsPlain(BenchState *state, size_t size)
+{
+    return bench_smallLists(state, size, false);
+}
+
+size_t bench_smallListsInline(BenchState *state, size_t size)
+{
+    return bench_smallLists(state, size, true);
+}
+
+/**
+ * @brief A record of the `records` benchmarks.
+ */
+typedef struct BenchRecord {
+    int64_t key;
+    int64_t value;
+} BenchRecord;
+
+/**
+ * @brief Builds a list of `size` records, sums one of their fields and
+ *        deletes the list. `packed` uses `cd9list_createListOfSize`.
+ */
+size_t bench_records(BenchState *state, size_t size, bool packed)
+{
+    bench_start(state);
+    CD9List *list = packed ?
+        cd9list_createListOfSizeWithAllocator(sizeof(BenchRecord),
+                                              &state->allocator) :
+        cd9list_createListWithAllocator(&state->allocator);
+
+    for(size_t i = 0; i < size; i++) {
+        BenchRecord record = {(int64_t)i, state->values[i]};
+
+        list->prependCopy(list, &record, sizeof(BenchRecord));
+    }
+
+    CD9FOREACH(list, record) {
+        state->sink += ((BenchRecord *)record)->value;
+    }
+
+    cd9list_deleteList(list);
+    bench_stop(state);
+
+    return 1;
+}
+
+size_t bench_recordsSeparate(BenchState *state, size_t size)
+{
+    return bench_records(state, size, false);
+}
+
+size_t bench_recordsPacked(BenchState *state, size_t size)
+{
+    return bench_records(state, size, true);
+}
+
+/**
+ * @brief The size of the elements of the `views` benchmarks.
+ */
+#define BENCH_PAYLOAD_SIZE 2048
+
+/**
+ * @brief Builds a list of `size` payloads of \ref BENCH_PAYLOAD_SIZE bytes
+ *        and derives a copy, a filtered list and a slice from it.
+ *        `refCounted` uses `cd9list_createRefCountedList`, so the derived
+ *        lists share the payloads.
+ */
+size_t bench_views(BenchState *state, size_t size, bool refCounted)
+{
+    CD9List *list = refCounted ?
+        cd9list_createRefCountedListWithAllocator(&state->allocator) :
+        cd9list_createListWithAllocator(&state->allocator);
+    unsigned char payload[BENCH_PAYLOAD_SIZE] = {0};
+
+    for(size_t i = 0; i < size; i++) {
+        memcpy(payload, &state->values[i], sizeof(int));
+        list->prependCopy(list, payload, BENCH_PAYLOAD_SIZE);
+    }
+
+    bench_start(state);
+    CD9List *copy     = list->copy(list);
+    CD9List *filtered = list->filter(list, NULL, bench_oddCmp);
+    CD9List *slice    = list->slice(list, size / 4, size - size / 4, 1);
+    bench_stop(state);
+
+    state->sink += copy->length + filtered->length + slice->length;
+
+    cd9list_deleteList(slice);
+    cd9list_deleteList(filtered);
+    cd9list_deleteList(copy);
+    cd9list_deleteList(list);
+
+    return 1;
+}
+
+size_t bench_viewsCopied(BenchState *state, size_t size)
+{
+    return bench_views(state, size, false);
+}
+
+size_t bench_viewsRefCounted(BenchState *state, size_t size)
+{
+    return bench_views(state, size, true);
+}
+
+size_t bench_copy(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createList(state, size, true);
+
+    bench_start(state);
+    CD9List *copy = list->copy(list);
+    bench_stop(state);
+
+    cd9list_deleteList(copy);
+    cd9list_deleteList(list);
+
+    return 1;
+}
+
+/**
+ * @brief Takes snapshots of a list in copy-on-write mode, see
+ *        `cd9list_setCopyOnWrite`.
+ */
+size_t bench_copyOnWrite(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createList(state, size, true);
+    size_t ops    = BENCH_MAX_OPS;
+
+    cd9list_setCopyOnWrite(list, true);
+
+    bench_start(state);
+    for(size_t i = 0; i < ops; i++) {
+        cd9list_deleteList(list->copy(list));
+    }
+    bench_stop(state);
+
+    cd9list_deleteList(list);
+
+    return ops;
+}
+
+size_t bench_concat(BenchState *state, size_t size)
+{
+    CD9List *first  = bench_createList(state, size / 2, true);
+    CD9List *second = bench_createList(state, size - size / 2, true);
+
+    bench_start(state);
+    CD9List *result = cd9list_concat(first, second);
+    bench_stop(state);
+
+    cd9list_deleteList(result);
+    cd9list_deleteList(second);
+    cd9list_deleteList(first);
+
+    return 1;
+}
+
+size_t bench_slice(BenchState *state, size_t size)
+{
+    CD9List *list = bench_createList(state, size, true);
+
+    bench_start(state);
+    CD9List *slice = list->slice(list, size / 4, size - size / 4, 1);
+    bench_stop(state);
+
+    cd9list_deleteList(slice);
+    cd9list_deleteList(list);
+
+    return 1;
+}
+
+static const Bench benches[] = {
+    {"append",                  bench_append,                0},
+    {"prepend",                 bench_prepend,               0},
+    {"insert_middle",           bench_insert,                0},
+    {"get",                     bench_get,                   0},
+    {"find",                    bench_find,                  0},
+    {"findByValue",             bench_findByValue,           0},
+    {"findByValue_large",       bench_findLargeMemcmp,       0},
+    {"findByValue_large_hashed",bench_findLargeHashed,       0},
+    {"findByValue_scattered",   bench_findScattered,         0},
+    {"find_predicate",          bench_findPredicateSingle,   0},
+    {"findBatched_predicate",   bench_findPredicateBatched,  0},
+    {"find_predicate_scattered",bench_findPredicateScattered,0},
+    {"findBatched_scattered",   bench_findBatchedScattered,  0},
+    {"scan_scattered",          bench_scanScattered,         0},
+    {"scan_scattered_prefetch", bench_scanScatteredPrefetch, 0},
+    {"scan_compacted",          bench_scanCompacted,         0},
+    {"simd_find",               bench_simdFind,              0},
+    {"remove_middle",           bench_remove,                0},
+    {"remove_scattered_loop",   bench_removeLoop,            BENCH_QUADRATIC_LIMIT},
+    {"removeIndices",           bench_removeIndices,         0},
+    {"pop",                     bench_pop,                   0},
+    {"popleft",                 bench_popleft,               0},
+    {"handoff_copy",            bench_handOffCopy,           0},
+    {"handoff_owned",           bench_handOffOwned,          0},
+    {"sort_random",             bench_sortRandom,            0},
+    {"sort_sorted",             bench_sortSorted,            0},
+    {"sort_reversed",           bench_sortReversed,          0},
+    {"tokens_sort",             bench_tokensSortList,        0},
+    {"tokens_sort_stringList",  bench_tokensSortStrings,     0},
+    {"tokens_find",             bench_tokensFindList,        BENCH_QUADRATIC_LIMIT},
+    {"tokens_find_stringList",  bench_tokensFindStrings,     BENCH_QUADRATIC_LIMIT},
+    {"topK",                    bench_topK,                  0},
+    {"nthElement",              bench_nthElement,            0},
+    {"merge_concat_sort",       bench_mergeConcatSort,       BENCH_QUADRATIC_LIMIT},
+    {"mergeSorted",             bench_mergeSorted,           0},
+    {"mergeK",                  bench_mergeK,                0},
+    {"filter",                  bench_filter,                0},
+    {"filterBySet",             bench_filterBySet,           0},
+    {"unique",                  bench_unique,                0},
+    {"countDistinct",           bench_countDistinct,         0},
+    {"chain_eager",             bench_chainEager,            0},
+    {"chain_query",             bench_chainQuery,            0},
+    {"records",                 bench_recordsSeparate,       0},
+    {"records_packed",          bench_recordsPacked,         0},
+    {"views",                   bench_viewsCopied,           0},
+    {"views_refCounted",        bench_viewsRefCounted,       0},
+    {"small_lists",             bench_smallListsPlain,       10},
+    {"small_lists_inline",      bench_smallListsInline,      10},
+    {"copy",                    bench_copy,                  0},
+    {"copy_cow",                bench_copyOnWrite,           0},
+    {"concat",                  bench_concat,                0},
+    {"slice",                   bench_slice,                 0},
+    {"slice_chunks",            bench_sliceChunks,           BENCH_QUADRATIC_LIMIT},
+    {"splitAt_chunks",          bench_splitChunks,           0},
+};
+
+long bench_peakRss()
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    return usage.ru_maxrss;
+}
+
+/**
+ * @brief Runs a benchmark for one size in a child process and prints its
+ *        row. The peak RSS is a high-water mark of the whole process, so a
+ *        fresh process is used for every run and only the growth over the
+ *        RSS the child starts with is reported.
+ *
+ * @return int It returns `1` on success or `0` if the child failed.
+ */
+int bench_runIsolated(BenchState *state, const Bench *bench, size_t size)
+{
+    fflush(stdout);
+
+    pid_t pid = fork();
+    if(pid < 0) {
+        perror("fork");
+        return 0;
+    }
+
+    if(pid == 0) {
+        long baseline = bench_peakRss();
+
+        state->elapsed = 0;
+        state->allocs  = 0;
+
+        size_t ops = bench->run(state, size);
+
+        printf("%s,%zu,%zu,%.1f,%zu,%ld\n", bench->name, size, ops,
+               state->elapsed * 1e9 / ops, state->allocs,
+               bench_peakRss() - baseline);
+        fflush(stdout);
+        _exit(0);
+    }
+
+    int status;
+
+    if(waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+       WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "%s,%zu failed\n", bench->name, size);
+        return 0;
+    }
+
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    size_t maxSize     = BENCH_DEFAULT_MAX_SIZE;
+    const char *filter = NULL;
+
+    if(argc > 1) {
+        maxSize = strtoull(argv[1], NULL, 10);
+    }
+
+    if(argc > 2) {
+        filter = argv[2];
+    }
+
+    BenchState state;
+    state.allocator.alloc = bench_alloc;
+    state.allocator.free  = bench_free;
+    state.allocator.ctx   = &state;
+    state.counting        = false;
+    state.seed            = 2463534242u;
+    state.sink            = 0;
+    state.values          = malloc(2 * maxSize * sizeof(int));
+    benchState            = &state;
+
+    if(state.values == NULL) {
+        fprintf(stderr, "Can't allocate the values for %zu elements\n",
+                maxSize);
+        return 1;
+    }
+
+    for(size_t i = 0; i < 2 * maxSize; i++) {
+        state.values[i] = (int)i;
+    }
+
+    // The output is CSV, so it can be diffed or loaded by other tools.
+    printf("benchmark,size,ops,ns_per_op,allocs,peak_rss_growth_kb\n");
+
+    for(size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+        const Bench *bench = &benches[b];
+
+        if(filter != NULL && strstr(bench->name, filter) == NULL) {
+            continue;
+        }
+
+        for(size_t size = 10; size <= maxSize; size *= 10) {
+            if(bench->maxSize != 0 && size > bench->maxSize) {
+                break;
+            }
+
+            if(!bench_runIsolated(&state, bench, size)) {
+                free(state.values);
+                return 1;
+            }
+        }
+    }
+
+    free(state.values);
+
+    return 0;
+}
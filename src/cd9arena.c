@@ -0,0 +1,109 @@
+#include <stdlib.h>
+#include "cd9arena.h"
+
+size_t cd9arena_align(size_t size)
+{
+    return (size + CD9ARENA_ALIGNMENT - 1) & ~(size_t)(CD9ARENA_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Helper function that allocates a new block able to hold at least
+ *        `size` bytes. The block is not linked to the arena.
+ *
+ * @param arena The arena.
+ * @param size The minimum number of bytes the block should hold.
+ *
+ * @return CD9ArenaBlock * The new block or `NULL` if malloc failed.
+ */
+CD9ArenaBlock *cd9arena_createBlock(CD9Arena *arena, size_t size)
+{
+    size_t header = cd9arena_align(sizeof(CD9ArenaBlock));
+
+    if(size < arena->blockSize) {
+        size = arena->blockSize;
+    }
+
+    // The header and the data of the block share the same allocation.
+    CD9ArenaBlock *block = malloc(header + size);
+    if(block == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    block->data = (unsigned char *)block + header;
+    block->size = size;
+    block->used = 0;
+    block->next = NULL;
+
+    return block;
+}
+
+CD9Arena *cd9arena_create(size_t blockSize)
+{
+    CD9Arena *arena = malloc(sizeof(CD9Arena));
+    if(arena == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    arena->blocks    = NULL;
+    arena->blockSize = cd9arena_align((blockSize != 0) ? blockSize :
+                                      CD9ARENA_DEFAULT_BLOCK_SIZE);
+    arena->refs      = 1;
+
+    return arena;
+}
+
+void *cd9arena_alloc(CD9Arena *arena, size_t size)
+{
+    CD9ArenaBlock *block = arena->blocks;
+
+    size = cd9arena_align(size);
+
+    if(block == NULL || block->size - block->used < size) {
+        CD9ArenaBlock *current = block;
+
+        block = cd9arena_createBlock(arena, size);
+        if(block == NULL) {
+            return NULL;
+        }
+
+        if(current != NULL && size > arena->blockSize) {
+            // A block of its own, keep carving from the current one.
+            block->next   = current->next;
+            current->next = block;
+        }
+        else {
+            block->next   = current;
+            arena->blocks = block;
+        }
+    }
+
+    void *memory = block->data + block->used;
+    block->used += size;
+
+    return memory;
+}
+
+CD9Arena *cd9arena_retain(CD9Arena *arena)
+{
+    arena->refs++;
+
+    return arena;
+}
+
+void cd9arena_release(CD9Arena *arena)
+{
+    if(--arena->refs != 0) {
+        return;
+    }
+
+    CD9ArenaBlock *block = arena->blocks;
+    CD9ArenaBlock *tmp;
+
+    while(block != NULL) {
+        tmp = block->next;
+        free(block);
+        block = tmp;
+    }
+
+    free(arena);
+}
@@ -0,0 +1,103 @@
+#ifndef CD9ARENA_H__
+#define CD9ARENA_H__
+
+#include <stddef.h>
+
+/**
+ * @brief The size of the blocks requested by an arena when the user doesn't
+ *        specify one.
+ */
+#define CD9ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+/**
+ * @brief Every allocation made from an arena is aligned to this value.
+ */
+#define CD9ARENA_ALIGNMENT 16
+
+/**
+ * @brief A block of memory owned by an arena. The allocations are carved
+ *        sequentially from `data`.
+ *
+ * @var CD9ArenaBlock::next The block that was filled before this one.
+ * @var CD9ArenaBlock::size The number of bytes that can be stored in `data`.
+ * @var CD9ArenaBlock::used The number of bytes already given away.
+ */
+typedef struct CD9ArenaBlock {
+    struct CD9ArenaBlock *next;
+    size_t size;
+    size_t used;
+    unsigned char *data;
+} CD9ArenaBlock;
+
+/**
+ * @brief A bump arena. Memory allocated from an arena is never freed one
+ *        allocation at a time, all of it is released at once when the arena
+ *        is deleted. An arena is reference counted, so it can back more than
+ *        one list, it will be deleted when the last reference is released.
+ *
+ * @var CD9Arena::blocks The block allocations are currently carved from,
+ *      followed by the blocks that were already filled.
+ * @var CD9Arena::blockSize The size of the blocks requested by the arena.
+ * @var CD9Arena::refs The number of references to the arena.
+ */
+typedef struct CD9Arena {
+    CD9ArenaBlock *blocks;
+    size_t blockSize;
+    size_t refs;
+} CD9Arena;
+
+/**
+ * @brief Use this function to create a new arena. The caller owns the only
+ *        reference to it and should release it with `cd9arena_release` when
+ *        it doesn't need it anymore.
+ *
+ * @param blockSize The size of the blocks requested by the arena. If it is
+ *        `0` then \ref CD9ARENA_DEFAULT_BLOCK_SIZE will be used.
+ *
+ * @return CD9Arena * A newly allocated arena.
+ */
+CD9Arena *cd9arena_create(size_t blockSize);
+
+/**
+ * @brief Use this function to round `size` up to \ref CD9ARENA_ALIGNMENT.
+ *        It tells you how much of an arena an allocation of `size` bytes
+ *        will really take.
+ *
+ * @param size The number of bytes.
+ *
+ * @return size_t The rounded size.
+ */
+size_t cd9arena_align(size_t size);
+
+/**
+ * @brief Use this function to allocate memory from an arena. Allocations
+ *        bigger than the block size get a block of their own.
+ *
+ * @param arena The arena.
+ * @param size The number of bytes you need.
+ *
+ * @return void * A pointer to the memory or `NULL` if there is no more
+ *         memory available.
+ */
+void *cd9arena_alloc(CD9Arena *arena, size_t size);
+
+/**
+ * @brief Use this function to take a new reference to an arena.
+ *
+ * @param arena The arena.
+ *
+ * @return CD9Arena * The same arena.
+ */
+CD9Arena *cd9arena_retain(CD9Arena *arena);
+
+/**
+ * @brief Use this function to release a reference to an arena. When the last
+ *        reference is released all the memory of the arena is freed.
+ *
+ * @param arena The arena.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9arena_release(CD9Arena *arena);
+
+#endif // CD9ARENA_H__
@@ -1,9 +1,78 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include "cd9list.h"
 #include "callbacks.h"
 
+#ifdef CD9LIST_STATS
+/**
+ * @brief Adds `amount` to the counter `member` of `list` and to the same
+ *        counter of the global stats. 
+ */
+#define CD9LIST_COUNT(list, member, amount) \
+    do { \
+        ((CD9List *)(list))->stats.member += (amount); \
+        cd9list_globalStats.member        += (amount); \
+    } while(0)
+
+CD9ListStats cd9list_globalStats;
+#else
+#define CD9LIST_COUNT(list, member, amount)
+#endif
+
+/**
+ * @brief The default hash. The copies are hashed 8 bytes at a time, and the
+ *        bits of the result, like the bits of the addresses, are mixed at
+ *        the end so the low bits depend on all of them.
+ */
+size_t cd9list_defaultHash(const void *data, size_t size)
+{
+    uint64_t hash;
+
+    if(size == SIZE_ZERO) {
+        hash = (uint64_t)(uintptr_t)data;
+    }
+    else {
+        const unsigned char *bytes = data;
+        size_t i                   = 0;
+
+        hash = 0xcbf29ce484222325ULL ^ size;
+
+        for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word;
+
+            memcpy(&word, bytes + i, sizeof(uint64_t));
+            hash ^= word;
+            hash *= 0x9e3779b97f4a7c15ULL;
+            hash ^= hash >> 32;
+        }
+
+        for(; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    return (size_t)hash;
+}
+
+/**
+ * @brief Helper function that computes the hash stored in a node, see
+ *        `cd9list_setHashing`. `0` means that there is no hash, so it is
+ *        never returned.
+ */
+size_t cd9list_hashCopy(const void *data, size_t size)
+{
+    size_t hash = cd9list_defaultHash(data, size);
+
+    return (hash != 0) ? hash : 1;
+}
+
 CD9Node *cd9list_createNode(const void *data, size_t size) 
 {
     CD9Node *node = malloc(sizeof(CD9Node));
@@ -28,440 +97,3004 @@ CD9Node *cd9list_createNode(const void *data, size_t size)
     return node;
 }
 
-CD9Node *cd9list_getNode(const CD9List *list, size_t index) 
+void *cd9list_mallocAlloc(void *ctx, size_t size)
 {
-   CD9FOREACH_(list, node, i) {
-        if(i == index) {
-            return node;
-        }
-    }
+    return malloc(size);
+}
 
-    return NULL;
+void cd9list_mallocFree(void *ctx, void *memory, size_t size)
+{
+    free(memory);
 }
 
-CD9List *cd9list_concat(CD9List *list1, CD9List *list2)
+/**
+ * @brief Helper function used to allocate every block of memory that belongs
+ *        to a list. The memory is carved from the arena of the list if it has
+ *        one, otherwise it is requested from the allocator of the list.
+ *
+ * @param list The list that will own the memory.
+ * @param size The number of bytes needed.
+ *
+ * @return void * A pointer to the memory or `NULL` if the allocation failed.
+ */
+void *cd9list_allocate(CD9List *list, size_t size)
 {
-    CD9List *result   = list1->copy(list1);
+    CD9LIST_COUNT(list, bytesAllocated, size);
 
-    CD9FOREACH_(list2, node) {
-        result->appendCopy(result, node->data, node->size);        
+    if(list->arena != NULL) {
+        return cd9arena_alloc(list->arena, size);
     }
 
-    return result;
+    return list->allocator.alloc(list->allocator.ctx, size);
 }
 
-void *cd9list_copyNodeData(const CD9Node *node)
+/**
+ * @brief Helper function used to free the memory allocated by 
+ *        `cd9list_allocate`.
+ *
+ * @param list The list that owns the memory.
+ * @param memory The memory that should be freed.
+ * @param size The size that was requested when the memory was allocated.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9list_release(CD9List *list, void *memory, size_t size)
 {
-    // The user was careless, he shouldn't call this function on an empty
-    // node.
-    if(node->size == SIZE_ZERO) {
-        return NULL; 
+    // Memory carved from an arena is freed together with the arena.
+    if(list->arena == NULL) {
+        CD9LIST_COUNT(list, bytesFreed, size);
+        list->allocator.free(list->allocator.ctx, memory, size);
     }
+}
 
-    void *data = malloc(node->size);
-    memmove(data, node->data, node->size);
-
-    return data;
+/**
+ * @brief Helper function that returns the header of a copy, see
+ *        \ref CD9List::payloadHeaders.
+ */
+CD9PayloadHeader *cd9list_payloadHeader(const CD9Node *node)
+{
+    return &((CD9PayloadRoom *)node->data - 1)->header;
 }
 
-void *cd9list_get(void *self, size_t index)
+/**
+ * @brief Helper function that returns the number of bytes taken by a copy of
+ *        `size` bytes of `list`, with its header if it has one.
+ */
+size_t cd9list_payloadSize(const CD9List *list, size_t size)
 {
-    CD9List *list = (CD9List *)self;
-    CD9Node *node = cd9list_getNode(list, index);
-    
-    return node->data;
+    return list->payloadHeaders ? sizeof(CD9PayloadRoom) + size : size;
 }
 
-void cd9list_append(void *self, const void *data)
+/**
+ * @brief Helper function that stores a copy of `data` in `memory`, after a
+ *        header if the copies of `list` have one.
+ *
+ * @return void * The copy.
+ */
+void *cd9list_storePayload(const CD9List *list,
+                           void          *memory,
+                           const void    *data,
+                           size_t        size)
 {
-    CD9List *list = (CD9List *)self;
-    list->_insertCopy(list, list->length, data, SIZE_ZERO);
+    if(!list->payloadHeaders) {
+        memmove(memory, data, size);
+        return memory;
+    }
+
+    CD9PayloadRoom *room = memory;
+
+    room->header.refs = 1;
+    room->header.hash = list->hashing ? cd9list_hashCopy(data, size) : 0;
+    memmove(room + 1, data, size);
+
+    return room + 1;
 }
 
-void cd9list_appendCopy(void *self, const void *data, size_t size)
+/**
+ * @brief Helper function that allocates a node and its copy with
+ *        `cd9list_allocate`, outside of the inline slots.
+ */
+CD9Node *cd9list_createHeapNode(CD9List *list, const void *data, size_t size)
 {
-    CD9List *list = (CD9List *)self;
-    list->_insertCopy(list, list->length, data, size);
+    if(list->elementSize != 0) {
+        // The node stops before `size`, see `CD9PackedNode`.
+        CD9PackedNode *packed = cd9list_allocate(list,
+            sizeof(CD9PackedNode) + cd9list_payloadSize(list, size));
+        if(packed == NULL) { // The allocation failed.
+            return NULL;
+        }
+
+        CD9Node *node = (CD9Node *)packed;
+
+        node->data = cd9list_storePayload(list, packed + 1, data, size);
+        node->next = NULL;
+
+        return node;
+    }
+
+    CD9Node *node = cd9list_allocate(list, sizeof(CD9Node));
+    if(node == NULL) { // The allocation failed.
+        return NULL;
+    }
+
+    if(size != SIZE_ZERO) {
+        void *memory = cd9list_allocate(list,
+                                        cd9list_payloadSize(list, size));
+        if(memory == NULL) {
+            cd9list_release(list, node, sizeof(CD9Node));
+            return NULL;
+        }
+
+        node->data = cd9list_storePayload(list, memory, data, size);
+    }
+    else {
+        memmove(&node->data, &data, sizeof(void *));
+    }
+
+    node->next = NULL;
+    node->size = size;
+
+    return node;
 }
 
-void cd9list_insert(void *self, size_t index, const void *data)
+size_t cd9list_nodeSize(const CD9List *list, const CD9Node *node)
 {
-    CD9List *list = (CD9List *)self;
-    list->_insertCopy(list, index, data, SIZE_ZERO);
+    return (list->elementSize != 0) ? list->elementSize : node->size;
 }
 
-void cd9list_prepend(void *self, const void *data)
+/**
+ * @brief Helper function that tells if `node` is kept inside `list`, see
+ *        `cd9list_createSmallList`.
+ */
+bool cd9list_isInline(const CD9List *list, const CD9Node *node)
 {
-    CD9List *list = (CD9List *)self;
-    list->_insertCopy(list, 0, data, SIZE_ZERO);
+    const CD9InlineSlots *slots = list->inlineSlots;
+
+    return slots != NULL && node >= slots->nodes &&
+           node < slots->nodes + CD9LIST_INLINE_NODES;
 }
 
-void cd9list_prependCopy(void *self, const void *data, size_t size)
+/**
+ * @brief Helper function that tells if the copy of `node` is stored after a
+ *        header, see \ref CD9List::payloadHeaders.
+ */
+bool cd9list_hasHeader(const CD9List *list, const CD9Node *node)
 {
-    CD9List *list = (CD9List *)self;
-    list->_insertCopy(list, 0, data, size);
+    return list->payloadHeaders &&
+           cd9list_nodeSize(list, node) != SIZE_ZERO &&
+           !cd9list_isInline(list, node);
 }
 
-void *cd9list_pop(void *self)
+/**
+ * @brief Helper function that returns the hash of the copy of `node`, see
+ *        `cd9list_setHashing`, or `0` if it has none.
+ */
+size_t cd9list_nodeHash(const CD9List *list, const CD9Node *node)
 {
-    CD9List *list = (CD9List *)self;
-    CD9Node *node = cd9list_getNode(list, list->length - 1);
+    return cd9list_hasHeader(list, node) ?
+           cd9list_payloadHeader(node)->hash : 0;
+}
 
-    if(node->size == SIZE_ZERO) {
-        void *tmp = node->data;
-        list->remove(list, list->length - 1);
+CD9Node *cd9list_createListNode(CD9List *list, const void *data, size_t size)
+{
+    CD9InlineSlots *slots = list->inlineSlots;
+    unsigned full         = (1u << CD9LIST_INLINE_NODES) - 1;
 
-        return tmp; 
+    // The nodes of a list of a given element size don't store a size.
+    if(list->elementSize != 0 && size != list->elementSize) {
+        return NULL;
     }
 
-    void *tmp = cd9list_copyNodeData(node);
-    list->remove(list, list->length - 1);
+    if(slots == NULL || slots->used == full || size > CD9LIST_INLINE_SIZE) {
+        return cd9list_createHeapNode(list, data, size);
+    }
 
-    return tmp;
-}
+    int slot = 0;
 
-void *cd9list_popleft(void *self)
-{
-    CD9List *list = (CD9List *)self;
-    CD9Node *node = cd9list_getNode(list, 0);
+    while(slots->used & (1u << slot)) {
+        slot++;
+    }
 
-    if(node->size == SIZE_ZERO) {
-        void *tmp = node->data;
-        list->remove(list, 0);
+    slots->used  |= 1u << slot;
+    CD9Node *node = &slots->nodes[slot];
 
-        return tmp;
+    if(size != SIZE_ZERO) {
+        memmove(slots->data[slot].bytes, data, size);
+        node->data = slots->data[slot].bytes;
+    }
+    else {
+        memmove(&node->data, &data, sizeof(void *));
     }
 
-    void *tmp = cd9list_copyNodeData(node);
-    list->remove(list, 0);
+    node->next = NULL;
+    node->size = size;
 
-    return tmp;
+    return node;
 }
 
-CD9List *cd9list_filter(void           *self, 
-                        const void     *data,
-                        CD9FindCallback cmp)
+/**
+ * @brief Helper function that moves the nodes kept inside a small list to
+ *        nodes of their own. It is called before the nodes are shared with
+ *        other lists or moved to them, since they can't outlive the list.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed, the nodes
+ *         moved so far stay moved.
+ */
+int cd9list_spill(CD9List *list)
 {
-    CD9List *list         = (CD9List *)self;
-    CD9List *filteredList = cd9list_createList();
-
-    CD9FOREACH_(list, node) {
-        if(!cmp(node->data, data, node->size)) {
-            filteredList->appendCopy(filteredList, node->data, node->size);        
-        }
+    if(list->inlineSlots == NULL || list->inlineSlots->used == 0) {
+        return 1;
     }
 
-    return filteredList;
-}    
+    CD9Node *prev = NULL;
 
-CD9List *cd9list_filterByValue(void *self, const void *data)
-{
-    CD9List *list     = (CD9List *)self;
-    CD9List *filtered = cd9list_createList();
+    for(CD9Node *node = list->nodes; node != NULL; node = node->next) {
+        if(cd9list_isInline(list, node)) {
+            CD9Node *moved = cd9list_createHeapNode(list, node->data,
+                                                    node->size);
+            if(moved == NULL) {
+                return 0;
+            }
 
-    CD9FOREACH_(list, node) {
-        if(node->size == SIZE_ZERO) {
-            if(!callbacks_findByAddressCmp(node->data, data, 0)) {
-                filtered->appendCopy(filtered, node->data, node->size);
+            moved->next = node->next;
+
+            if(prev == NULL) {
+                list->nodes = moved;
             }
-        }
-        else {
-            if(!callbacks_findByValueCmp(node->data, data, node->size)) {
-                filtered->appendCopy(filtered, node->data, node->size);
+            else {
+                prev->next = moved;
             }
+
+            cd9list_deleteListNode(list, node);
+            node = moved;
         }
+
+        prev = node;
     }
 
-    return filtered;
+    return 1;
 }
 
-CD9List *cd9list_filterBySet(void *self, CD9List *set)
+CD9Node *cd9list_getNode(const CD9List *list, size_t index) 
 {
-    CD9List *list     = (CD9List *)self;
-    CD9List *filtered = cd9list_createList();
-
-    CD9FOREACH_(list, node) {
-        if(node->size == SIZE_ZERO) {
-            if(set->findByAddress(set, node->data) == -1) {
-                filtered->appendCopy(filtered, node->data, node->size);
-            }
-        }
-        else {
-            if(set->findByValue(set, node->data) == -1) {
-                filtered->appendCopy(filtered, node->data, node->size);
-            }
+   CD9FOREACH_(list, node, i) {
+        if(i == index) {
+            CD9LIST_COUNT(list, nodesVisited, i + 1);
+            return node;
         }
     }
 
-    return filtered;
+    CD9LIST_COUNT(list, nodesVisited, list->length);
+
+    return NULL;
 }
 
-void cd9list_reverse(void *self)
+CD9List *cd9list_createListLike(const CD9List *list)
 {
-    CD9List *list = (CD9List *)self;
-
-    CD9Node *start = list->nodes->next;
-    CD9Node *prev  = list->nodes;
-    CD9Node *tmp;
-
-    prev->next = NULL;
+    CD9List *result = (list->inlineSlots != NULL) ?
+                      cd9list_createSmallListWithAllocator(&list->allocator) :
+                      cd9list_createListWithAllocator(&list->allocator);
+    if(result == NULL) {
+        return NULL;
+    }
 
-    while(start != NULL) {
-        tmp = start->next;
-        start->next = prev;
-        prev = start;
-        start = tmp;
+    if(list->arena != NULL) {
+        result->arena = cd9arena_retain(list->arena);
     }
 
-    list->nodes = prev;
+    result->copyOnWrite    = list->copyOnWrite;
+    result->hashing        = list->hashing;
+    result->elementSize    = list->elementSize;
+    result->refCounted     = list->refCounted;
+    result->payloadHeaders = list->payloadHeaders;
+
+    return result;
 }
 
-void cd9list_insertCopy(void       *self, 
-                        size_t     index, 
-                        const void *data, 
-                        size_t     size)
+/**
+ * @brief Helper function that lets go of a shared chain. The last list that
+ *        lets it go frees the nodes.
+ */
+void cd9list_releaseShared(CD9SharedNodes *shared)
 {
-    CD9List *list = (CD9List *)self;
+    if(--shared->refs != 0) {
+        return;
+    }
 
-    if(index == 0) {
-        CD9Node *node = cd9list_createNode(data, size);
-        CD9Node *tmp = list->nodes;
-        
-        list->nodes = node;
-        node->next = tmp;
-        
-        list->length++;
+    CD9Allocator allocator = shared->allocator;
 
-        return;
+    if(shared->arena != NULL) {
+        cd9arena_release(shared->arena);
     }
- 
-    CD9Node *beforeDesiredNode = cd9list_getNode(list, index - 1); 
-    CD9Node *tmp               = beforeDesiredNode->next;
-    CD9Node *node              = cd9list_createNode(data, size);
-    
-    // Adjust the links.
-    beforeDesiredNode->next = node;
-    node->next = tmp;
+    else {
+        CD9Node *node = shared->nodes;
 
-    list->length++;
-}
+        while(node != NULL) {
+            CD9Node *next = node->next;
 
-CD9List *cd9list_copy(void *self)
-{
-    CD9List *list       = (CD9List *)self;
-    CD9List *secondList = cd9list_createList();
+            size_t room = shared->payloadHeaders ? sizeof(CD9PayloadRoom) : 0;
 
-    CD9FOREACH_(list, node) {
-        secondList->appendCopy(secondList, node->data, node->size);
+            if(shared->elementSize != 0) {
+                allocator.free(allocator.ctx, node, sizeof(CD9PackedNode) +
+                               room + shared->elementSize);
+            }
+            else if(shared->payloadHeaders && node->size != SIZE_ZERO) {
+                CD9PayloadHeader *header = cd9list_payloadHeader(node);
+
+                if(--header->refs == 0) {
+                    allocator.free(allocator.ctx, header, room + node->size);
+                }
+
+                allocator.free(allocator.ctx, node, sizeof(CD9Node));
+            }
+            else {
+                if(node->size != SIZE_ZERO) {
+                    allocator.free(allocator.ctx, node->data, node->size);
+                }
+
+                allocator.free(allocator.ctx, node, sizeof(CD9Node));
+            }
+
+            node = next;
+        }
     }
 
-    return secondList;
+    allocator.free(allocator.ctx, shared, sizeof(CD9SharedNodes));
 }
 
-CD9List *cd9list_slice(void *self, int start, int stop, size_t step)
+/**
+ * @brief Helper function that hands the nodes of a list over to a shared
+ *        chain, if the list doesn't share its nodes yet.
+ *
+ * @return CD9SharedNodes * The chain or `NULL` if malloc failed.
+ */
+CD9SharedNodes *cd9list_share(CD9List *list)
 {
-    CD9List *list   = (CD9List *)self;
-    CD9List *result = cd9list_createList();
-
-    if(start < 0) {
-        // Since start is negatice, adding it is equivalent to the substraction
-        // of the absolute value of start.
-        start = list->length + start;
+    if(list->shared != NULL) {
+        return list->shared;
     }
 
-    if(stop < 0) {
-        stop = list->length + stop;
+    // The other lists may outlive this one.
+    if(!cd9list_spill(list)) {
+        return NULL;
     }
 
-    if(stop == 0) {
-        stop = list->length;
+    CD9SharedNodes *shared = list->allocator.alloc(list->allocator.ctx,
+                                                   sizeof(CD9SharedNodes));
+    if(shared == NULL) { // The allocation failed.
+        return NULL;
     }
 
-    for(size_t i = start; i < stop; i += step) {
-        CD9Node *node = cd9list_getNode(list, i);
-        result->appendCopy(result, node->data, node->size);
-    }
+    shared->refs           = 1;
+    shared->nodes          = list->nodes;
+    shared->arena          = (list->arena != NULL) ?
+                             cd9arena_retain(list->arena) : NULL;
+    shared->allocator      = list->allocator;
+    shared->elementSize    = list->elementSize;
+    shared->refCounted     = list->refCounted;
+    shared->payloadHeaders = list->payloadHeaders;
 
-    return result;
+    list->shared      = shared;
+    list->sharedNodes = list->nodes;
+    list->ownLength   = 0;
+
+    return shared;
 }
 
-int cd9list_remove(void *self, size_t index)
+/**
+ * @brief Helper function that frees a chain of nodes owned by `list`.
+ */
+void cd9list_deleteChain(CD9List *list, CD9Node *nodes)
 {
-    CD9List *list = (CD9List *)self;
-    
-    if(index < 0 || index > (list->length - 1)) {
-        return 0; // Not a valid index;
-    } 
+    while(nodes != NULL) {
+        CD9Node *next = nodes->next;
 
-    if(index == 0) {
-        CD9Node *toDelete = list->nodes;
-        list->nodes = toDelete->next;
-        cd9list_deleteNode(toDelete);
-        list->length--;
+        cd9list_deleteListNode(list, nodes);
+        nodes = next;
     }
-    else {
+}
+
+/**
+ * @brief Helper function that tells if the nodes allocated from `arena`, or
+ *        from `allocator` when there is no arena, with the layout of a list
+ *        of `elementSize` whose copies are reference counted or not and have
+ *        a header or not, can be freed by `list`. Only then can nodes be
+ *        moved to `list` without copying them.
+ */
+bool cd9list_sameOwner(const CD9List      *list,
+                       const CD9Arena     *arena,
+                       const CD9Allocator *allocator,
+                       size_t             elementSize,
+                       bool               refCounted,
+                       bool               payloadHeaders)
+{
+    if(arena != list->arena || elementSize != list->elementSize ||
+       refCounted != list->refCounted ||
+       payloadHeaders != list->payloadHeaders) {
+        return false;
+    }
+
+    return arena != NULL ||
+           (allocator->alloc == list->allocator.alloc &&
+            allocator->free == list->allocator.free &&
+            allocator->ctx == list->allocator.ctx);
+}
+
+/**
+ * @brief Helper function that tells if `list` can share the copies of
+ *        `source` instead of copying them, see
+ *        `cd9list_createRefCountedList`.
+ */
+bool cd9list_sharesPayloads(const CD9List *list, const CD9List *source)
+{
+    return list->refCounted &&
+           cd9list_sameOwner(list, source->arena, &source->allocator,
+                             source->elementSize, source->refCounted,
+                             source->payloadHeaders);
+}
+
+/**
+ * @brief Helper function that creates a node of `list` for the element of
+ *        `node`, a node of `source`. If `share` is `true` the new node uses
+ *        the copy of `node`, whose reference count is incremented, otherwise
+ *        the element is copied.
+ *
+ * @return CD9Node * The new node or `NULL` if malloc failed.
+ */
+CD9Node *cd9list_shareNode(CD9List       *list,
+                           const CD9List *source,
+                           const CD9Node *node,
+                           bool          share)
+{
+    size_t size = cd9list_nodeSize(source, node);
+
+    if(!share || size == SIZE_ZERO) {
+        return cd9list_createListNode(list, node->data, size);
+    }
+
+    CD9Node *result = cd9list_allocate(list, sizeof(CD9Node));
+    if(result == NULL) { // The allocation failed.
+        return NULL;
+    }
+
+    CD9PayloadHeader *header = cd9list_payloadHeader(node);
+
+    header->refs++;
+
+    // The hash only depends on the copy, every list that uses it can use it.
+    if(list->hashing && header->hash == 0) {
+        header->hash = cd9list_hashCopy(node->data, size);
+    }
+
+    result->data = node->data;
+    result->next = NULL;
+    result->size = size;
+
+    return result;
+}
+
+/**
+ * @brief Helper function used to build the lists derived from another list.
+ *        It appends a node for the element of `node` after `*tail`, so the
+ *        result is not walked for every element.
+ *
+ * @param list The new list, it doesn't share nodes.
+ * @param tail The last node of `list`, it is updated.
+ * @param source The list `node` belongs to.
+ * @param node The node whose element is appended.
+ * @param share See `cd9list_shareNode`.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed.
+ */
+int cd9list_appendNode(CD9List       *list,
+                       CD9Node       **tail,
+                       const CD9List *source,
+                       const CD9Node *node,
+                       bool          share)
+{
+    CD9Node *copy = cd9list_shareNode(list, source, node, share);
+    if(copy == NULL) {
+        return 0;
+    }
+
+    if(*tail == NULL) {
+        list->nodes = copy;
+    }
+    else {
+        (*tail)->next = copy;
+    }
+
+    *tail = copy;
+    list->length++;
+
+    return 1;
+}
+
+/**
+ * @brief Helper function used by `copy`, `slice` and `concat` in
+ *        copy-on-write mode. It returns a list that holds the elements of
+ *        `list` from `start` to the end. The nodes that `list` doesn't share
+ *        yet are shared from now on, the ones that `list` owns alone are
+ *        copied.
+ *
+ * @param like The list the result takes its allocator and mode from.
+ * @param list The list whose nodes are shared.
+ * @param start The index of the first element.
+ *
+ * @return CD9List * The new list or `NULL` if malloc failed.
+ */
+CD9List *cd9list_shareFrom(const CD9List *like, CD9List *list, size_t start)
+{
+    CD9List *result = cd9list_createListLike(like);
+
+    if(result == NULL || start >= list->length) {
+        return result;
+    }
+
+    if(cd9list_share(list) == NULL) {
+        cd9list_deleteList(result);
+        return NULL;
+    }
+
+    CD9Node *node = list->nodes;
+    CD9Node *tail = NULL;
+    size_t i      = 0;
+    bool share    = cd9list_sharesPayloads(result, list);
+
+    for(; i < start; i++) {
+        node = node->next;
+    }
+
+    for(; i < list->ownLength; i++, node = node->next) {
+        CD9Node *copy = cd9list_shareNode(result, list, node, share);
+        if(copy == NULL) {
+            cd9list_deleteList(result);
+            return NULL;
+        }
+
+        if(tail == NULL) {
+            result->nodes = copy;
+        }
+        else {
+            tail->next = copy;
+        }
+
+        tail = copy;
+        result->ownLength++;
+    }
+
+    if(tail == NULL) {
+        result->nodes = node;
+    }
+    else {
+        tail->next = node;
+    }
+
+    result->shared      = list->shared;
+    result->sharedNodes = node;
+    result->length      = list->length - start;
+    list->shared->refs++;
+
+    return result;
+}
+
+void cd9list_setCopyOnWrite(CD9List *list, bool enabled)
+{
+    list->copyOnWrite = enabled;
+}
+
+/**
+ * @brief Helper function that tells if `list` is the last list that shares
+ *        its chain and can take the shared nodes as they are.
+ */
+bool cd9list_ownsShared(const CD9List *list)
+{
+    CD9SharedNodes *shared = list->shared;
+
+    return shared->refs == 1 &&
+           cd9list_sameOwner(list, shared->arena, &shared->allocator,
+                             shared->elementSize, shared->refCounted,
+                             shared->payloadHeaders);
+}
+
+/**
+ * @brief Helper function used by `cd9list_unshare` and `cd9list_popOwned`.
+ *        It gives `list` its own copies of the shared nodes before `end` and
+ *        lets the shared chain go. The nodes from `end` on are left out of
+ *        the list, pass `NULL` to keep all of them.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed, the list is
+ *         not changed in that case.
+ */
+int cd9list_copyShared(CD9List *list, const CD9Node *end)
+{
+    CD9SharedNodes *shared = list->shared;
+    CD9Node *nodes         = NULL;
+    CD9Node *tail          = NULL;
+    bool share             = list->refCounted &&
+                             cd9list_sameOwner(list, shared->arena,
+                                               &shared->allocator,
+                                               shared->elementSize,
+                                               shared->refCounted,
+                                               shared->payloadHeaders);
+
+    for(CD9Node *node = list->sharedNodes; node != end; node = node->next) {
+        CD9Node *copy = cd9list_shareNode(list, list, node, share);
+
+        if(copy == NULL) {
+            cd9list_deleteChain(list, nodes);
+            return 0;
+        }
+
+        if(tail == NULL) {
+            nodes = copy;
+        }
+        else {
+            tail->next = copy;
+        }
+
+        tail = copy;
+    }
+
+    if(list->ownLength == 0) {
+        list->nodes = nodes;
+    }
+    else {
+        cd9list_getNode(list, list->ownLength - 1)->next = nodes;
+    }
+
+    cd9list_releaseShared(shared);
+
+    list->shared      = NULL;
+    list->sharedNodes = NULL;
+    list->ownLength   = 0;
+
+    return 1;
+}
+
+int cd9list_unshare(CD9List *list)
+{
+    CD9SharedNodes *shared = list->shared;
+
+    if(shared == NULL) {
+        return 1;
+    }
+
+    if(!cd9list_ownsShared(list)) {
+        return cd9list_copyShared(list, NULL);
+    }
+
+    // Nobody else sees these nodes, the list can simply take them. The
+    // nodes before them are not seen by any list either, they are freed
+    // with the chain.
+    if(shared->nodes == list->sharedNodes) {
+        shared->nodes = NULL;
+    }
+    else {
+        CD9Node *node = shared->nodes;
+
+        while(node->next != list->sharedNodes) {
+            node = node->next;
+        }
+
+        node->next = NULL;
+    }
+
+    cd9list_releaseShared(shared);
+
+    list->shared      = NULL;
+    list->sharedNodes = NULL;
+    list->ownLength   = 0;
+
+    return 1;
+}
+
+/**
+ * @brief Helper function that moves the copies of `list` after a header,
+ *        see \ref CD9List::payloadHeaders. The copies are moved to new nodes,
+ *        and the old nodes are only freed once every copy was moved.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed, the list is
+ *         not changed in that case.
+ */
+int cd9list_addHeaders(CD9List *list)
+{
+    // The other lists that share the nodes keep them as they are.
+    if(!cd9list_unshare(list)) {
+        return 0;
+    }
+
+    CD9Node *moved = NULL;
+    CD9Node *tail  = NULL;
+
+    list->payloadHeaders = true;
+
+    CD9FOREACH_(list, node) {
+        // The copies kept inside a small list stay there.
+        if(!cd9list_hasHeader(list, node)) {
+            continue;
+        }
+
+        CD9Node *copy = cd9list_createHeapNode(list, node->data,
+                                               cd9list_nodeSize(list, node));
+        if(copy == NULL) {
+            cd9list_deleteChain(list, moved);
+            list->payloadHeaders = false;
+
+            return 0;
+        }
+
+        if(tail == NULL) {
+            moved = copy;
+        }
+        else {
+            tail->next = copy;
+        }
+
+        tail = copy;
+    }
+
+    // The new nodes take the place of the old ones, in the same order.
+    CD9Node *prev = NULL;
+    CD9Node *old  = NULL;
+    CD9Node *node = list->nodes;
+
+    while(node != NULL) {
+        CD9Node *next = node->next;
+
+        if(cd9list_hasHeader(list, node)) {
+            CD9Node *copy = moved;
+
+            moved      = moved->next;
+            copy->next = next;
+            node->next = old;
+            old        = node;
+            node       = copy;
+
+            if(prev == NULL) {
+                list->nodes = node;
+            }
+            else {
+                prev->next = node;
+            }
+        }
+
+        prev = node;
+        node = next;
+    }
+
+    list->payloadHeaders = false;
+    cd9list_deleteChain(list, old);
+    list->payloadHeaders = true;
+
+    return 1;
+}
+
+int cd9list_setHashing(CD9List *list, bool enabled)
+{
+    if(enabled && !list->payloadHeaders && !cd9list_addHeaders(list)) {
+        return 0;
+    }
+
+    list->hashing = enabled;
+
+    if(!enabled) {
+        return 1;
+    }
+
+    // The hashes only depend on the copies, so the shared copies can be
+    // updated as well.
+    CD9FOREACH_(list, node) {
+        if(cd9list_hasHeader(list, node)) {
+            cd9list_payloadHeader(node)->hash =
+                cd9list_hashCopy(node->data, cd9list_nodeSize(list, node));
+        }
+    }
+
+    return 1;
+}
+
+bool cd9list_equals(const CD9List *list1, const CD9List *list2)
+{
+    if(list1->length != list2->length) {
+        return false;
+    }
+
+    CD9Node *node1 = list1->nodes;
+    CD9Node *node2 = list2->nodes;
+
+    for(; node1 != NULL; node1 = node1->next, node2 = node2->next) {
+        CD9PREFETCH_HINT(node1);
+        CD9PREFETCH_HINT(node2);
+
+        if(node1 == node2) {
+            // The rest of the nodes is shared, see `cd9list_setCopyOnWrite`.
+            return true;
+        }
+
+        size_t size = cd9list_nodeSize(list1, node1);
+
+        if(size != cd9list_nodeSize(list2, node2)) {
+            return false;
+        }
+
+        if(size == SIZE_ZERO) {
+            if(node1->data != node2->data) {
+                return false;
+            }
+
+            continue;
+        }
+
+        size_t hash1 = cd9list_nodeHash(list1, node1);
+        size_t hash2 = cd9list_nodeHash(list2, node2);
+
+        if(hash1 != 0 && hash2 != 0 && hash1 != hash2) {
+            return false;
+        }
+
+        if(memcmp(node1->data, node2->data, size) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+CD9List *cd9list_concat(CD9List *list1, CD9List *list2)
+{
+    // Sharing hands the nodes of `list2` over to a shared chain, so it is
+    // only done when `list2` is in copy-on-write mode as well. Otherwise the
+    // next change past its front would copy the whole list. The shared
+    // nodes must also have the layout of the nodes of the result.
+    if(list1->copyOnWrite && list2->copyOnWrite &&
+       list1->elementSize == list2->elementSize &&
+       list1->payloadHeaders == list2->payloadHeaders) {
+        CD9LIST_COUNT(list1, operations[CD9LIST_OP_CONCAT], 1);
+
+        // The result shares the nodes of `list2`, the elements of `list1`
+        // are copied in front of them.
+        CD9List *result = cd9list_shareFrom(list1, list2, 0);
+        if(result == NULL) {
+            return NULL;
+        }
+
+        CD9Node *nodes = NULL;
+        CD9Node *tail  = NULL;
+        bool share     = cd9list_sharesPayloads(result, list1);
+
+        CD9FOREACH_(list1, node) {
+            CD9Node *copy = cd9list_shareNode(result, list1, node, share);
+            if(copy == NULL) {
+                cd9list_deleteChain(result, nodes);
+                cd9list_deleteList(result);
+                return NULL;
+            }
+
+            if(tail == NULL) {
+                nodes = copy;
+            }
+            else {
+                tail->next = copy;
+            }
+
+            tail = copy;
+        }
+
+        if(tail != NULL) {
+            tail->next    = result->nodes;
+            result->nodes = nodes;
+        }
+
+        // Without shared nodes every node belongs to the result.
+        if(result->shared != NULL) {
+            result->ownLength += list1->length;
+        }
+
+        result->length += list1->length;
+
+        return result;
+    }
+
+    CD9List *result = cd9list_createListLike(list1);
+    if(result == NULL) {
+        return NULL;
+    }
+
+    CD9LIST_COUNT(list1, operations[CD9LIST_OP_CONCAT], 1);
+
+    CD9Node *tail = NULL;
+    bool share1   = cd9list_sharesPayloads(result, list1);
+    bool share2   = cd9list_sharesPayloads(result, list2);
+
+    CD9FOREACH_(list1, node) {
+        if(!cd9list_appendNode(result, &tail, list1, node, share1)) {
+            cd9list_deleteList(result);
+            return NULL;
+        }
+    }
+
+    CD9FOREACH_(list2, node) {
+        if(!cd9list_appendNode(result, &tail, list2, node, share2)) {
+            cd9list_deleteList(result);
+            return NULL;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief A slot of the table used by `cd9list_unique` and
+ *        `cd9list_countDistinct`, `node` is `NULL` if the slot is free.
+ */
+typedef struct CD9HashSlot {
+    const CD9Node *node;
+    size_t hash;
+} CD9HashSlot;
+
+/**
+ * @brief The default equality: the copies must have the same bytes and the
+ *        addresses must be the same address.
+ */
+bool cd9list_defaultEqual(const void *a, size_t sizeA,
+                          const void *b, size_t sizeB)
+{
+    if(sizeA != sizeB) {
+        return false;
+    }
+
+    return (sizeA == SIZE_ZERO) ? a == b : memcmp(a, b, sizeA) == 0;
+}
+
+/**
+ * @brief Helper function that allocates a table with room for `count`
+ *        elements. The table is at most half full, so the probes stay short.
+ *
+ * @return CD9HashSlot * The table or `NULL` if malloc failed.
+ */
+CD9HashSlot *cd9list_createHashTable(size_t count, size_t *mask)
+{
+    size_t capacity = 16;
+
+    while(capacity < count * 2) {
+        capacity *= 2;
+    }
+
+    *mask = capacity - 1;
+
+    return calloc(capacity, sizeof(CD9HashSlot));
+}
+
+/**
+ * @brief Helper function that adds `node`, a node of `list`, to the table,
+ *        unless an equal element is already there.
+ *
+ * @return bool It returns `true` if the node was added.
+ */
+bool cd9list_addDistinct(CD9HashSlot      *table,
+                         size_t           mask,
+                         const CD9List    *list,
+                         const CD9Node    *node,
+                         CD9HashCallback  hash,
+                         CD9EqualCallback equal)
+{
+    size_t size   = cd9list_nodeSize(list, node);
+    size_t stored = cd9list_nodeHash(list, node);
+
+    // The default hash is the one stored in the nodes.
+    size_t value = (hash == cd9list_hashCopy && stored != 0) ?
+                   stored : hash(node->data, size);
+
+    for(size_t i = value & mask; ; i = (i + 1) & mask) {
+        CD9HashSlot *slot = &table[i];
+
+        if(slot->node == NULL) {
+            slot->node = node;
+            slot->hash = value;
+
+            return true;
+        }
+
+        if(slot->hash == value &&
+           equal(slot->node->data, cd9list_nodeSize(list, slot->node),
+                 node->data, size)) {
+            return false;
+        }
+    }
+}
+
+size_t cd9list_unique(CD9List          *list,
+                      CD9HashCallback  hash,
+                      CD9EqualCallback equal)
+{
+    size_t mask;
+    size_t removed = 0;
+
+    hash  = (hash != NULL) ? hash : cd9list_hashCopy;
+    equal = (equal != NULL) ? equal : cd9list_defaultEqual;
+
+    if(list->length < 2) {
+        return 0;
+    }
+
+    CD9HashSlot *table = cd9list_createHashTable(list->length, &mask);
+    if(table == NULL) { // Malloc failed.
+        return 0;
+    }
+
+    // The duplicates are unlinked anywhere in the list.
+    if(!cd9list_unshare(list)) {
+        free(table);
+        return 0;
+    }
+
+    CD9Node *prev = NULL;
+    CD9Node *node = list->nodes;
+
+    while(node != NULL) {
+        CD9PREFETCH_HINT(node);
+
+        CD9Node *next = node->next;
+
+        if(cd9list_addDistinct(table, mask, list, node, hash, equal)) {
+            prev = node;
+        }
+        else {
+            // The first node is always kept, so `prev` is set.
+            prev->next = next;
+            cd9list_deleteListNode(list, node);
+            removed++;
+        }
+
+        node = next;
+    }
+
+    list->length -= removed;
+    free(table);
+
+    return removed;
+}
+
+size_t cd9list_countDistinct(const CD9List    *list,
+                             CD9HashCallback  hash,
+                             CD9EqualCallback equal)
+{
+    size_t mask;
+    size_t distinct = 0;
+
+    hash  = (hash != NULL) ? hash : cd9list_hashCopy;
+    equal = (equal != NULL) ? equal : cd9list_defaultEqual;
+
+    if(list->length < 2) {
+        return list->length;
+    }
+
+    CD9HashSlot *table = cd9list_createHashTable(list->length, &mask);
+    if(table == NULL) { // Malloc failed.
+        return 0;
+    }
+
+    CD9FOREACH_(list, node) {
+        if(cd9list_addDistinct(table, mask, list, node, hash, equal)) {
+            distinct++;
+        }
+    }
+
+    free(table);
+
+    return distinct;
+}
+
+void *cd9list_copyNodeData(const CD9List *list, const CD9Node *node)
+{
+    size_t size = (list != NULL) ? cd9list_nodeSize(list, node) : node->size;
+
+    // The user was careless, he shouldn't call this function on an empty
+    // node.
+    if(size == SIZE_ZERO) {
+        return NULL;
+    }
+
+    void *data = malloc(size);
+    if(data != NULL) {
+        memcpy(data, node->data, size);
+    }
+
+    return data;
+}
+
+void *cd9list_get(void *self, size_t index)
+{
+    CD9List *list = (CD9List *)self;
+    CD9Node *node = cd9list_getNode(list, index);
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_GET], 1);
+    
+    return node->data;
+}
+
+int cd9list_append(void *self, const void *data)
+{
+    CD9List *list = (CD9List *)self;
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_APPEND], 1);
+    return list->_insertCopy(list, list->length, data, SIZE_ZERO);
+}
+
+int cd9list_appendCopy(void *self, const void *data, size_t size)
+{
+    CD9List *list = (CD9List *)self;
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_APPEND], 1);
+    return list->_insertCopy(list, list->length, data, size);
+}
+
+int cd9list_insert(void *self, size_t index, const void *data)
+{
+    CD9List *list = (CD9List *)self;
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_INSERT], 1);
+    return list->_insertCopy(list, index, data, SIZE_ZERO);
+}
+
+int cd9list_prepend(void *self, const void *data)
+{
+    CD9List *list = (CD9List *)self;
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_PREPEND], 1);
+    return list->_insertCopy(list, 0, data, SIZE_ZERO);
+}
+
+int cd9list_prependCopy(void *self, const void *data, size_t size)
+{
+    CD9List *list = (CD9List *)self;
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_PREPEND], 1);
+    return list->_insertCopy(list, 0, data, size);
+}
+
+void *cd9list_pop(void *self)
+{
+    CD9List *list = (CD9List *)self;
+    CD9Node *node = cd9list_getNode(list, list->length - 1);
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_POP], 1);
+
+    if(cd9list_nodeSize(list, node) == SIZE_ZERO) {
+        void *tmp = node->data;
+        list->remove(list, list->length - 1);
+
+        return tmp; 
+    }
+
+    void *tmp = cd9list_copyNodeData(list, node);
+    list->remove(list, list->length - 1);
+
+    return tmp;
+}
+
+void *cd9list_popleft(void *self)
+{
+    CD9List *list = (CD9List *)self;
+    CD9Node *node = cd9list_getNode(list, 0);
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_POPLEFT], 1);
+
+    if(cd9list_nodeSize(list, node) == SIZE_ZERO) {
+        void *tmp = node->data;
+        list->remove(list, 0);
+
+        return tmp;
+    }
+
+    void *tmp = cd9list_copyNodeData(list, node);
+    list->remove(list, 0);
+
+    return tmp;
+}
+
+CD9List *cd9list_filter(void           *self, 
+                        const void     *data,
+                        CD9FindCallback cmp)
+{
+    CD9List *list         = (CD9List *)self;
+    CD9List *filteredList = cd9list_createListLike(list);
+    if(filteredList == NULL) {
+        return NULL;
+    }
+
+    CD9Node *tail = NULL;
+    bool share    = cd9list_sharesPayloads(filteredList, list);
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_FILTER], 1);
+
+    CD9FOREACH_(list, node) {
+        CD9LIST_COUNT(list, callbacks, 1);
+
+        if(!cmp(node->data, data, cd9list_nodeSize(list, node)) &&
+           !cd9list_appendNode(filteredList, &tail, list, node, share)) {
+            cd9list_deleteList(filteredList);
+            return NULL;
+        }
+    }
+
+    return filteredList;
+}    
+
+/**
+ * @brief The value looked for by `findByValue`, `filterByValue` and
+ *        `filterBySet`, compared with the hashes of the nodes in the lists
+ *        that store them. The elements are compared with the size of the
+ *        node, so the hash is computed again when the size changes.
+ *
+ * @var CD9Key::data The value.
+ * @var CD9Key::size The size `hash` was computed with.
+ * @var CD9Key::hash The hash or `0` if it wasn't computed yet.
+ */
+typedef struct CD9Key {
+    const void *data;
+    size_t size;
+    size_t hash;
+} CD9Key;
+
+/**
+ * @brief Helper function that returns the hash of the `size` first bytes of
+ *        the key, see `cd9list_hashCopy`.
+ */
+size_t cd9list_keyHash(CD9Key *key, size_t size)
+{
+    if(key->hash == 0 || key->size != size) {
+        key->size = size;
+        key->hash = cd9list_hashCopy(key->data, size);
+    }
+
+    return key->hash;
+}
+
+/**
+ * @brief Helper function that compares the copy of `node` with `key`, in
+ *        place. The common sizes are compared with a `memcmp` of a constant
+ *        size, which the compiler turns into a load and a compare. In the
+ *        lists that store hashes, the bytes are only compared when the hashes
+ *        are equal.
+ *
+ * @param list The list the node belongs to.
+ * @param node The node.
+ * @param key The value the element is compared with.
+ * @param addressCmp The comparator used for the nodes that store addresses.
+ *
+ * @return bool It returns `true` if the element is equal to `key`.
+ */
+bool cd9list_keyMatches(const CD9List   *list,
+                        const CD9Node   *node,
+                        CD9Key          *key,
+                        CD9FindCallback addressCmp)
+{
+    size_t size = cd9list_nodeSize(list, node);
+
+    if(size == SIZE_ZERO) {
+        return addressCmp(node->data, key->data, size);
+    }
+
+    // The nodes without a hash are compared like the others.
+    size_t hash = list->hashing ? cd9list_nodeHash(list, node) : 0;
+
+    if(hash != 0 && hash != cd9list_keyHash(key, size)) {
+        return false;
+    }
+
+    switch(size) {
+        case 1:  return memcmp(node->data, key->data, 1) == 0;
+        case 2:  return memcmp(node->data, key->data, 2) == 0;
+        case 4:  return memcmp(node->data, key->data, 4) == 0;
+        case 8:  return memcmp(node->data, key->data, 8) == 0;
+        case 16: return memcmp(node->data, key->data, 16) == 0;
+        default: return memcmp(node->data, key->data, size) == 0;
+    }
+}
+
+CD9List *cd9list_filterByValue(void *self, const void *data)
+{
+    CD9List *list     = (CD9List *)self;
+    CD9List *filtered = cd9list_createListLike(list);
+    CD9Node *tail     = NULL;
+    CD9Key key        = {data, 0, 0};
+
+    if(filtered == NULL) {
+        return NULL;
+    }
+
+    bool share = cd9list_sharesPayloads(filtered, list);
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_FILTER], 1);
+
+    CD9FOREACH_(list, node) {
+        CD9LIST_COUNT(list, callbacks, 1);
+
+        if(!cd9list_keyMatches(list, node, &key, callbacks_findByAddressCmp) &&
+           !cd9list_appendNode(filtered, &tail, list, node, share)) {
+            cd9list_deleteList(filtered);
+            return NULL;
+        }
+    }
+
+    return filtered;
+}
+
+/**
+ * @brief Helper function that does the work of `findByValue`, the hash of
+ *        the key may already be known.
+ */
+int cd9list_findKey(CD9List *list, CD9Key *key)
+{
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_FIND], 1);
+
+    CD9FOREACH_(list, node, i) {
+        if(cd9list_keyMatches(list, node, key, callbacks_findByValueCmp)) {
+            CD9LIST_COUNT(list, callbacks, i + 1);
+            return i;
+        }
+    }
+
+    CD9LIST_COUNT(list, callbacks, list->length);
+
+    return -1;
+}
+
+CD9List *cd9list_filterBySet(void *self, CD9List *set)
+{
+    CD9List *list     = (CD9List *)self;
+    CD9List *filtered = cd9list_createListLike(list);
+    if(filtered == NULL) {
+        return NULL;
+    }
+
+    CD9Node *tail = NULL;
+    bool share    = cd9list_sharesPayloads(filtered, list);
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_FILTER], 1);
+
+    CD9FOREACH_(list, node) {
+        size_t size = cd9list_nodeSize(list, node);
+        bool found;
+
+        if(size == SIZE_ZERO) {
+            found = set->findByAddress(set, node->data) != -1;
+        }
+        else {
+            // The hash of the node is reused if the set stores hashes too.
+            CD9Key key = {node->data, size, cd9list_nodeHash(list, node)};
+
+            found = cd9list_findKey(set, &key) != -1;
+        }
+
+        if(!found && !cd9list_appendNode(filtered, &tail, list, node, share)) {
+            cd9list_deleteList(filtered);
+            return NULL;
+        }
+    }
+
+    return filtered;
+}
+
+void cd9list_reverse(void *self)
+{
+    CD9List *list = (CD9List *)self;
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_REVERSE], 1);
+
+    if(!cd9list_unshare(list)) {
+        return;
+    }
+
+    CD9Node *start = list->nodes->next;
+    CD9Node *prev  = list->nodes;
+    CD9Node *tmp;
+
+    prev->next = NULL;
+
+    while(start != NULL) {
+        tmp = start->next;
+        start->next = prev;
+        prev = start;
+        start = tmp;
+    }
+
+    list->nodes = prev;
+}
+
+int cd9list_insertCopy(void       *self, 
+                       size_t     index, 
+                       const void *data, 
+                       size_t     size)
+{
+    CD9List *list = (CD9List *)self;
+
+    if(index > list->length ||
+       (list->elementSize != 0 && size != list->elementSize)) {
+        return 0;
+    }
+
+    // The nodes can be added in front of the shared nodes, but not between
+    // them.
+    if(list->shared != NULL && index > list->ownLength &&
+       !cd9list_unshare(list)) {
+        return 0;
+    }
+
+    CD9Node *node = cd9list_createListNode(list, data, size);
+    if(node == NULL) { // Malloc failed.
+        return 0;
+    }
+
+    if(list->shared != NULL) {
+        list->ownLength++;
+    }
+
+    if(index == 0) {
+        CD9Node *tmp = list->nodes;
+        
+        list->nodes = node;
+        node->next = tmp;
+        
+        list->length++;
+
+        return 1;
+    }
+ 
+    CD9Node *beforeDesiredNode = cd9list_getNode(list, index - 1); 
+    CD9Node *tmp               = beforeDesiredNode->next;
+    
+    // Adjust the links.
+    beforeDesiredNode->next = node;
+    node->next = tmp;
+
+    list->length++;
+
+    return 1;
+}
+
+CD9List *cd9list_copy(void *self)
+{
+    CD9List *list = (CD9List *)self;
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_COPY], 1);
+
+    if(list->copyOnWrite) {
+        return cd9list_shareFrom(list, list, 0);
+    }
+
+    CD9List *secondList = cd9list_createListLike(list);
+    if(secondList == NULL) {
+        return NULL;
+    }
+
+    CD9Node *tail = NULL;
+    bool share    = cd9list_sharesPayloads(secondList, list);
+
+    CD9FOREACH_(list, node) {
+        if(!cd9list_appendNode(secondList, &tail, list, node, share)) {
+            cd9list_deleteList(secondList);
+            return NULL;
+        }
+    }
+
+    return secondList;
+}
+
+CD9List *cd9list_slice(void *self, int start, int stop, size_t step)
+{
+    CD9List *list = (CD9List *)self;
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_SLICE], 1);
+
+    // A step of 0 would never reach the next element.
+    if(step == 0) {
+        return NULL;
+    }
+
+    CD9List *result = cd9list_createListLike(list);
+    if(result == NULL) {
+        return NULL;
+    }
+
+    if(start < 0) {
+        // Since start is negatice, adding it is equivalent to the substraction
+        // of the absolute value of start.
+        start = list->length + start;
+    }
+
+    if(stop < 0) {
+        stop = list->length + stop;
+    }
+
+    if(stop == 0) {
+        stop = list->length;
+    }
+
+    // The end of a list can be shared, see `cd9list_setCopyOnWrite`.
+    if(list->copyOnWrite && step == 1 && start >= 0 &&
+       (size_t)stop == list->length) {
+        cd9list_deleteList(result);
+
+        return cd9list_shareFrom(list, list, start);
+    }
+
+    CD9Node *tail = NULL;
+    bool share    = cd9list_sharesPayloads(result, list);
+
+    // The list is walked once, instead of once per element.
+    CD9FOREACH_(list, node, i) {
+        if(i >= (size_t)stop) {
+            break;
+        }
+
+        if(i < (size_t)start || (i - start) % step != 0) {
+            continue;
+        }
+
+        if(!cd9list_appendNode(result, &tail, list, node, share)) {
+            cd9list_deleteList(result);
+            return NULL;
+        }
+    }
+
+    return result;
+}
+
+int cd9list_remove(void *self, size_t index)
+{
+    CD9List *list = (CD9List *)self;
+    
+    if(index < 0 || index > (list->length - 1)) {
+        return 0; // Not a valid index;
+    } 
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_REMOVE], 1);
+
+    // Only the link before the first shared node can change without
+    // copying the shared nodes.
+    if(list->shared != NULL && index > list->ownLength &&
+       !cd9list_unshare(list)) {
+        return 0;
+    }
+
+    CD9Node *toDelete;
+
+    if(index == 0) {
+        toDelete = list->nodes;
+        list->nodes = toDelete->next;
+    }
+    else {
+        CD9Node *prev = cd9list_getNode(list, index - 1);
+        toDelete = prev->next;
+
+        prev->next = toDelete->next;
+    }
+
+    if(toDelete == list->sharedNodes) {
+        // The node is shared, it is only skipped.
+        list->sharedNodes = toDelete->next;
+
+        if(list->sharedNodes == NULL) {
+            cd9list_releaseShared(list->shared);
+            list->shared = NULL;
+        }
+    }
+    else {
+        cd9list_deleteListNode(list, toDelete);
+
+        if(list->shared != NULL) {
+            list->ownLength--;
+        }
+    }
+
+    list->length--;
+
+    return 1; // Removed successfully.
+}
+
+CD9List *cd9list_splitAt(CD9List *list, size_t index)
+{
+    CD9List *tail = cd9list_createListLike(list);
+    if(tail == NULL) {
+        return NULL;
+    }
+
+    if(index >= list->length) {
+        return tail;
+    }
+
+    // The cut is in the middle of the shared nodes.
+    if(list->shared != NULL && index > list->ownLength &&
+       !cd9list_unshare(list)) {
+        cd9list_deleteList(tail);
+        return NULL;
+    }
+
+    // The nodes kept inside `list` can't move to the new list. The copies
+    // made by `cd9list_unshare` may be kept there too, so it comes after.
+    if(!cd9list_spill(list)) {
+        cd9list_deleteList(tail);
+        return NULL;
+    }
+
+    if(list->shared != NULL) {
+        // The shared nodes all go to the new list, with the chain.
+        tail->shared      = list->shared;
+        tail->sharedNodes = list->sharedNodes;
+        tail->ownLength   = list->ownLength - index;
+
+        list->shared      = NULL;
+        list->sharedNodes = NULL;
+        list->ownLength   = 0;
+    }
+
+    if(index == 0) {
+        tail->nodes = list->nodes;
+        list->nodes = NULL;
+    }
+    else {
+        CD9Node *last = cd9list_getNode(list, index - 1);
+
+        tail->nodes = last->next;
+        last->next  = NULL;
+    }
+
+    tail->length = list->length - index;
+    list->length = index;
+
+    return tail;
+}
+
+int cd9list_rotate(CD9List *list, size_t count)
+{
+    if(list->length < 2 || count % list->length == 0) {
+        return 1;
+    }
+
+    if(!cd9list_unshare(list)) {
+        return 0;
+    }
+
+    count %= list->length;
+
+    // The node before the new head becomes the last one.
+    CD9Node *newLast = cd9list_getNode(list, count - 1);
+    CD9Node *last    = newLast;
+
+    while(last->next != NULL) {
+        CD9PREFETCH_HINT(last);
+        last = last->next;
+    }
+
+    last->next    = list->nodes;
+    list->nodes   = newLast->next;
+    newLast->next = NULL;
+
+    return 1;
+}
+
+/**
+ * @brief Helper function that tells if the copies of a list are allocated
+ *        with `malloc`, so they can be handed to the caller or taken from
+ *        the caller as they are.
+ */
+bool cd9list_usesMalloc(const CD9List *list)
+{
+    return list->arena == NULL && list->allocator.alloc == cd9list_mallocAlloc;
+}
+
+/**
+ * @brief Helper function that frees a node unlinked from `list`. If `data`
+ *        is not `NULL` it is filled with the data of the node the way `pop`
+ *        returns it, the copies belong to the caller who frees them with
+ *        `free`.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed, the node is
+ *         not freed in that case.
+ */
+int cd9list_dropNode(CD9List *list, CD9Node *node, void **data)
+{
+    if(data != NULL) {
+        if(cd9list_nodeSize(list, node) == SIZE_ZERO) {
+            *data = node->data;
+        }
+        else if(cd9list_usesMalloc(list) && !list->payloadHeaders &&
+                list->elementSize == 0 && !cd9list_isInline(list, node)) {
+            // The copy was allocated with malloc, it can be handed over
+            // without copying it again.
+            *data = node->data;
+
+            CD9LIST_COUNT(list, bytesFreed, node->size);
+            cd9list_release(list, node, sizeof(CD9Node));
+
+            return 1;
+        }
+        else {
+            *data = cd9list_copyNodeData(list, node);
+
+            if(*data == NULL) { // Malloc failed.
+                return 0;
+            }
+        }
+    }
+
+    cd9list_deleteListNode(list, node);
+
+    return 1;
+}
+
+/**
+ * @brief Helper function used by `cd9list_appendOwned` and
+ *        `cd9list_prependOwned`. It adds a node that adopts `data`.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed.
+ */
+int cd9list_insertOwned(CD9List *list, size_t index, void *data, size_t size)
+{
+    if(size == SIZE_ZERO) {
+        return 0;
+    }
+
+    // The nodes can be added in front of the shared nodes, but not between
+    // them.
+    if(list->shared != NULL && index > list->ownLength &&
+       !cd9list_unshare(list)) {
+        return 0;
+    }
+
+    CD9Node *node;
+
+    if(cd9list_usesMalloc(list) && !list->payloadHeaders &&
+       list->elementSize == 0) {
+        node = cd9list_allocate(list, sizeof(CD9Node));
+        if(node == NULL) { // Malloc failed.
+            return 0;
+        }
+
+        // The buffer is counted as if the list had allocated it.
+        CD9LIST_COUNT(list, bytesAllocated, size);
+
+        node->data = data;
+        node->size = size;
+    }
+    else {
+        // The list can't free a buffer allocated with `malloc`, or it
+        // stores a header in front of its copies, so it keeps a copy.
+        node = cd9list_createListNode(list, data, size);
+        if(node == NULL) {
+            return 0;
+        }
+
+        free(data);
+    }
+
+    if(index == 0) {
+        node->next  = list->nodes;
+        list->nodes = node;
+    }
+    else {
         CD9Node *prev = cd9list_getNode(list, index - 1);
-        CD9Node *toDelete = cd9list_getNode(list, index);
 
-        prev->next = toDelete->next;
-        cd9list_deleteNode(toDelete);
-        
-        list->length--;
+        node->next = prev->next;
+        prev->next = node;
+    }
+
+    if(list->shared != NULL) {
+        list->ownLength++;
+    }
+
+    list->length++;
+
+    return 1;
+}
+
+int cd9list_appendOwned(CD9List *list, void *data, size_t size)
+{
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_APPEND], 1);
+
+    return cd9list_insertOwned(list, list->length, data, size);
+}
+
+int cd9list_prependOwned(CD9List *list, void *data, size_t size)
+{
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_PREPEND], 1);
+
+    return cd9list_insertOwned(list, 0, data, size);
+}
+
+void *cd9list_popOwned(CD9List *list, size_t *size)
+{
+    if(list->length == 0) {
+        return NULL;
+    }
+
+    // The last node is shared if the list shares any node. When other lists
+    // still use it, only the shared nodes before it are copied, and the
+    // caller gets a copy of the element.
+    if(list->shared != NULL && !cd9list_ownsShared(list)) {
+        CD9Node *node = cd9list_getNode(list, list->length - 1);
+        size_t length = cd9list_nodeSize(list, node);
+        void *data    = (length == SIZE_ZERO) ?
+                        node->data : cd9list_copyNodeData(list, node);
+
+        if(length != SIZE_ZERO && data == NULL) { // Malloc failed.
+            return NULL;
+        }
+
+        if(!cd9list_copyShared(list, node)) {
+            if(length != SIZE_ZERO) {
+                free(data);
+            }
+
+            return NULL;
+        }
+
+        CD9LIST_COUNT(list, operations[CD9LIST_OP_POP], 1);
+
+        if(size != NULL) {
+            *size = length;
+        }
+
+        list->length--;
+
+        return data;
+    }
+
+    if(!cd9list_unshare(list)) {
+        return NULL;
+    }
+
+    CD9Node *prev = (list->length > 1) ?
+                    cd9list_getNode(list, list->length - 2) : NULL;
+    CD9Node *node = (prev != NULL) ? prev->next : list->nodes;
+    size_t length = cd9list_nodeSize(list, node);
+    void *data;
+
+    if(!cd9list_dropNode(list, node, &data)) {
+        return NULL;
+    }
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_POP], 1);
+
+    if(prev == NULL) {
+        list->nodes = NULL;
+    }
+    else {
+        prev->next = NULL;
+    }
+
+    if(size != NULL) {
+        *size = length;
+    }
+
+    list->length--;
+
+    return data;
+}
+
+void *cd9list_popleftOwned(CD9List *list, size_t *size)
+{
+    CD9Node *node = list->nodes;
+    void *data;
+
+    if(node == NULL) {
+        return NULL;
+    }
+
+    CD9Node *next = node->next;
+    size_t length = cd9list_nodeSize(list, node);
+
+    // The node is unlinked only once its data was taken, so nothing is lost
+    // if malloc fails.
+    if(node == list->sharedNodes) {
+        // The other lists still use the node, the caller gets a copy.
+        data = (length == SIZE_ZERO) ?
+               node->data : cd9list_copyNodeData(list, node);
+
+        if(length != SIZE_ZERO && data == NULL) { // Malloc failed.
+            return NULL;
+        }
+
+        list->sharedNodes = next;
+
+        if(list->sharedNodes == NULL) {
+            cd9list_releaseShared(list->shared);
+            list->shared = NULL;
+        }
+    }
+    else {
+        if(!cd9list_dropNode(list, node, &data)) {
+            return NULL;
+        }
+
+        if(list->shared != NULL) {
+            list->ownLength--;
+        }
+    }
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_POPLEFT], 1);
+
+    if(size != NULL) {
+        *size = length;
+    }
+
+    list->nodes = next;
+    list->length--;
+
+    return data;
+}
+
+/**
+ * @brief This is the signature of the tests used by `cd9list_removeWhere`.
+ *
+ * @return bool It returns `true` if the node should be removed.
+ */
+typedef bool (*CD9RemoveTest)(const CD9Node *node, size_t index,
+                              void *context);
+
+/**
+ * @brief Helper function that removes the nodes picked by `test` in a
+ *        single walk of the list. The walk stops after `limit` nodes were
+ *        removed, or early if malloc failed while copying the data of a
+ *        node, which stays in the list. The list must not share the nodes
+ *        that are removed.
+ *
+ * @param removed Filled with the data of the removed nodes in the order of
+ *        the list, see `cd9list_dropNode`, or `NULL`.
+ *
+ * @return size_t The number of nodes removed.
+ */
+size_t cd9list_removeWhere(CD9List       *list,
+                           CD9RemoveTest test,
+                           void          *context,
+                           size_t        limit,
+                           void          **removed)
+{
+    CD9Node *prev = NULL;
+    CD9Node *node = list->nodes;
+    size_t index  = 0;
+    size_t count  = 0;
+
+    while(node != NULL && count < limit) {
+        CD9PREFETCH_HINT(node);
+
+        CD9Node *next = node->next;
+
+        if(test(node, index++, context)) {
+            if(!cd9list_dropNode(list, node,
+                                 (removed != NULL) ? &removed[count] : NULL)) {
+                break;
+            }
+
+            if(prev == NULL) {
+                list->nodes = next;
+            }
+            else {
+                prev->next = next;
+            }
+
+            count++;
+        }
+        else {
+            prev = node;
+        }
+
+        node = next;
+    }
+
+    list->length -= count;
+
+    if(list->shared != NULL) {
+        list->ownLength -= count;
+    }
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_REMOVE], count);
+
+    return count;
+}
+
+/**
+ * @brief The state of `cd9list_removeIndices` while the list is walked.
+ */
+typedef struct CD9IndexCursor {
+    const size_t *indices;
+    size_t next;
+} CD9IndexCursor;
+
+/**
+ * @brief The test of `cd9list_removeIndices`, the indices are sorted so
+ *        only the next one has to be checked.
+ */
+bool cd9list_isNextIndex(const CD9Node *node, size_t index, void *context)
+{
+    CD9IndexCursor *cursor = context;
+
+    if(cursor->indices[cursor->next] != index) {
+        return false;
+    }
+
+    cursor->next++;
+
+    return true;
+}
+
+/**
+ * @brief Helper function used to sort the indices with `qsort`.
+ */
+int cd9list_compareIndices(const void *a, const void *b)
+{
+    size_t first  = *(const size_t *)a;
+    size_t second = *(const size_t *)b;
+
+    return (first > second) - (first < second);
+}
+
+/**
+ * @brief Helper function that removes the elements at `indices`, which are
+ *        sorted, distinct and valid.
+ */
+size_t cd9list_removeSorted(CD9List      *list,
+                            const size_t *indices,
+                            size_t       count,
+                            void         **removed)
+{
+    if(count == 0) {
+        return 0;
+    }
+
+    // Only the nodes the list owns can be unlinked without copying the
+    // shared ones.
+    if(list->shared != NULL && indices[count - 1] >= list->ownLength &&
+       !cd9list_unshare(list)) {
+        return 0;
+    }
+
+    CD9IndexCursor cursor = {indices, 0};
+
+    return cd9list_removeWhere(list, cd9list_isNextIndex, &cursor, count,
+                               removed);
+}
+
+size_t cd9list_removeIndices(CD9List      *list,
+                             const size_t *indices,
+                             size_t       count,
+                             void         **removed)
+{
+    size_t *sorted = malloc((count + 1) * sizeof(size_t));
+    if(sorted == NULL) { // Malloc failed.
+        return 0;
+    }
+
+    size_t valid = 0;
+
+    for(size_t i = 0; i < count; i++) {
+        if(indices[i] < list->length) {
+            sorted[valid++] = indices[i];
+        }
+    }
+
+    qsort(sorted, valid, sizeof(size_t), cd9list_compareIndices);
+
+    // Every element is removed once.
+    size_t distinct = 0;
+
+    for(size_t i = 0; i < valid; i++) {
+        if(distinct == 0 || sorted[distinct - 1] != sorted[i]) {
+            sorted[distinct++] = sorted[i];
+        }
+    }
+
+    size_t result = cd9list_removeSorted(list, sorted, distinct, removed);
+
+    free(sorted);
+
+    return result;
+}
+
+/**
+ * @brief The state of `cd9list_removeNodes` while the list is walked, the
+ *        nodes to remove are kept in a hash table.
+ */
+typedef struct CD9NodeSet {
+    CD9HashSlot *table;
+    size_t mask;
+} CD9NodeSet;
+
+/**
+ * @brief Helper function that adds a node to the set.
+ *
+ * @return bool It returns `true` if the node was not in the set yet.
+ */
+bool cd9list_addToNodeSet(CD9NodeSet *set, const CD9Node *node)
+{
+    size_t hash = cd9list_defaultHash(node, SIZE_ZERO);
+
+    for(size_t i = hash & set->mask; ; i = (i + 1) & set->mask) {
+        if(set->table[i].node == NULL) {
+            set->table[i].node = node;
+            return true;
+        }
+
+        if(set->table[i].node == node) {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief The test of `cd9list_removeNodes`.
+ */
+bool cd9list_inNodeSet(const CD9Node *node, size_t index, void *context)
+{
+    CD9NodeSet *set = context;
+    size_t hash     = cd9list_defaultHash(node, SIZE_ZERO);
+
+    for(size_t i = hash & set->mask; ; i = (i + 1) & set->mask) {
+        if(set->table[i].node == NULL) {
+            return false;
+        }
+
+        if(set->table[i].node == node) {
+            return true;
+        }
+    }
+}
+
+size_t cd9list_removeNodes(CD9List        *list,
+                           CD9Node *const *nodes,
+                           size_t         count,
+                           void           **removed)
+{
+    CD9NodeSet set;
+    size_t distinct = 0;
+
+    set.table = cd9list_createHashTable(count, &set.mask);
+    if(set.table == NULL) { // Malloc failed.
+        return 0;
+    }
+
+    for(size_t i = 0; i < count; i++) {
+        if(nodes[i] != NULL && cd9list_addToNodeSet(&set, nodes[i])) {
+            distinct++;
+        }
+    }
+
+    size_t result = 0;
+
+    if(list->shared == NULL) {
+        result = cd9list_removeWhere(list, cd9list_inNodeSet, &set, distinct,
+                                     removed);
+    }
+    else {
+        // The shared nodes may be copied before they are unlinked, so the
+        // nodes are found by their index.
+        size_t *indices = malloc((distinct + 1) * sizeof(size_t));
+        size_t found    = 0;
+
+        if(indices != NULL) {
+            CD9FOREACH_(list, node, index) {
+                if(found < distinct && cd9list_inNodeSet(node, index, &set)) {
+                    indices[found++] = index;
+                }
+            }
+
+            result = cd9list_removeSorted(list, indices, found, removed);
+            free(indices);
+        }
+    }
+
+    free(set.table);
+
+    return result;
+}
+
+int cd9list_find(void *self, const void *toFind, CD9FindCallback cmp)
+{
+    CD9List *list = (CD9List *)self;
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_FIND], 1);
+
+    CD9FOREACH_(list, node, index) {
+        CD9LIST_COUNT(list, callbacks, 1);
+
+        if(cmp(node->data, toFind, cd9list_nodeSize(list, node))) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+int cd9list_findByAddress(void *self, const void *data) 
+{
+    CD9List *list = (CD9List *)self;
+
+    return list->find(list, data, callbacks_findByAddressCmp);
+}
+
+int cd9list_findByValue(void *self, const void *data)
+{
+    CD9Key key = {data, 0, 0};
+
+    return cd9list_findKey(self, &key);
+}
+
+/**
+ * @brief Helper function that collects the data and the sizes of up to
+ *        \ref CD9LIST_FIND_BATCH elements, starting with `node`.
+ *
+ * @param list The list the nodes belong to.
+ * @param node The first node of the batch.
+ * @param nodes Filled with the nodes of the batch.
+ * @param items Filled with the data of the elements.
+ * @param sizes Filled with the sizes of the elements.
+ * @param count Filled with the number of elements.
+ *
+ * @return CD9Node * The node after the batch.
+ */
+CD9Node *cd9list_gatherItems(const CD9List *list,
+                             CD9Node       *node,
+                             const CD9Node **nodes,
+                             const void    **items,
+                             size_t        *sizes,
+                             size_t        *count)
+{
+    size_t n = 0;
+
+    while(node != NULL && n < CD9LIST_FIND_BATCH) {
+        // The callback reads the data only after the whole batch was
+        // gathered, it should be in the cache by then.
+        CD9PREFETCH_NODE(node);
+
+        CD9Node *next = node->next;
+
+        nodes[n]   = node;
+        items[n]   = node->data;
+        sizes[n++] = cd9list_nodeSize(list, node);
+        node       = next;
+    }
+
+    *count = n;
+
+    return node;
+}
+
+int cd9list_findBatched(const CD9List        *list,
+                        const void           *key,
+                        CD9BatchFindCallback cmp)
+{
+    int index = 0;
+
+    const CD9Node *nodes[CD9LIST_FIND_BATCH];
+    const void *items[CD9LIST_FIND_BATCH];
+    size_t sizes[CD9LIST_FIND_BATCH];
+    uint8_t matches[CD9LIST_FIND_BATCH];
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_FIND], 1);
+
+    for(CD9Node *node = list->nodes; node != NULL;) {
+        size_t count;
+
+        node = cd9list_gatherItems(list, node, nodes, items, sizes,
+                                   &count);
+        cmp(items, sizes, count, key, matches);
+
+        CD9LIST_COUNT(list, callbacks, count);
+
+        for(size_t i = 0; i < count; i++) {
+            if(matches[i]) {
+                return index + i;
+            }
+        }
+
+        index += count;
+    }
+
+    return -1;
+}
+
+CD9List *cd9list_filterBatched(const CD9List        *list,
+                               const void           *key,
+                               CD9BatchFindCallback cmp)
+{
+    CD9List *filtered = cd9list_createListLike(list);
+    CD9Node *tail     = NULL;
+    bool share        = false;
+
+    const CD9Node *nodes[CD9LIST_FIND_BATCH];
+    const void *items[CD9LIST_FIND_BATCH];
+    size_t sizes[CD9LIST_FIND_BATCH];
+    uint8_t matches[CD9LIST_FIND_BATCH];
+
+    if(filtered == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    share = cd9list_sharesPayloads(filtered, list);
+
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_FILTER], 1);
+
+    for(CD9Node *node = list->nodes; node != NULL;) {
+        size_t count;
+
+        node = cd9list_gatherItems(list, node, nodes, items, sizes,
+                                   &count);
+        cmp(items, sizes, count, key, matches);
+
+        CD9LIST_COUNT(list, callbacks, count);
+
+        for(size_t i = 0; i < count; i++) {
+            if(!matches[i] &&
+               !cd9list_appendNode(filtered, &tail, list, nodes[i], share)) {
+                cd9list_deleteList(filtered);
+                return NULL;
+            }
+        }
+    }
+
+    return filtered;
+}
+
+/**
+ * @brief Helper function used by `cd9list_mergeSort` in order to combine 2
+ *        sublists.
+ *
+ * @param part1 Pointer to the first sublist.
+ * @param part2 Pointer to the second sublist.
+ * @param cmp The comparison function, see \ref CD9List::sort for more details. 
+ *
+ * @return CD9Node * A pointer to the merged version of the 2 parts.
+ */
+CD9Node *cd9list_merge(CD9Node *part1, 
+                       CD9Node *part2, 
+                       int (*cmp)(const void *, const void *))
+{
+    CD9Node *temp;
+
+#ifdef CD9LIST_STATS
+    // We don't know the list here, `cd9list_sort` will add the comparisons
+    // to the stats of the list.
+    cd9list_globalStats.comparisons++;
+#endif
+
+    if(cmp(part1->data, part2->data) <= 0) {
+        temp  = part1;
+        part1 = part1->next; 
+    }
+    else {
+        temp  = part2;
+        part2 = part2->next;
+    }
+
+    CD9Node *current = temp;
+
+    while(part1 != NULL && part2 != NULL) {
+#ifdef CD9LIST_STATS
+        cd9list_globalStats.comparisons++;
+#endif
+
+        CD9PREFETCH_HINT(part1);
+        CD9PREFETCH_HINT(part2);
+
+        if(cmp(part1->data, part2->data) <= 0) {
+            current->next = part1;
+            part1         = part1->next; 
+        }
+        else {
+            current->next = part2;
+            part2         = part2->next;
+        }
+        current = current->next;
     }
 
-    return 1; // Removed successfully.
+    if(part1 != NULL) {
+        current->next = part1;
+    }
+
+    if(part2 != NULL) {
+        current->next = part2;
+    }
+
+    return temp;
+}  
+
+/**
+ * @brief This is a helper function, its main purpose is to return a pointer
+ *        to the node of the list refered by `start` and `stop`. We can't use
+ *        `cd9list_getNode` since it requires a pointer to the list and we 
+ *        don't have access to it inside `cd9list_mergeSort`.
+ * 
+ * @param start The starting node of the list.
+ * @param stop Pointer to the end of the list.
+ *
+ * @return CD9Node * A pointer to the middle node of the list delimited by
+ *         `start` and `stop`.
+ */ 
+CD9Node *cd9list_getMidNode(CD9Node *start, CD9Node *stop)
+{
+    CD9Node *front = start;
+    CD9Node *back  = start->next;
+
+    while(back != stop) {
+        back = back->next;
+        if(back != stop) {
+            back  = back->next;
+            front = front->next;
+        }
+    }
+
+    return front;
 }
 
-int cd9list_find(void *self, const void *toFind, CD9FindCallback cmp)
+/**
+ * @brief This is the function called by `cd9list_sort` in order to sort a 
+ *        list. It implements the merge sort algorithm.
+ * 
+ * @param start A pointer to the starting node of the list that should be
+ *        sorted.
+ * @param stop A pointer to the stoping node of the list.
+ * @param cmp The comparison function. See \ref CD9List::sort for more details.
+ *
+ * @return CD9Node * It returns a pointer to the sorted version of the list.
+ */ 
+CD9Node *cd9list_mergeSort(CD9Node *start,
+                           CD9Node *stop,
+                           int (*cmp)(const void *, const void *))
+{
+    if(start == stop) {
+        start->next = NULL;
+        return start;
+    }
+
+    CD9Node *midNode     = cd9list_getMidNode(start, stop->next);
+    CD9Node *midNodeNext = midNode->next;
+    
+    CD9Node *part1 = cd9list_mergeSort(start, midNode, cmp);
+    CD9Node *part2 = cd9list_mergeSort(midNodeNext, stop, cmp);
+
+    return cd9list_merge(part1, part2, cmp);
+}    
+
+void cd9list_sort(void *self, int (*cmp)(const void *, const void *))
 {
     CD9List *list = (CD9List *)self;
 
-    CD9FOREACH_(list, node, index) {
-        if(cmp(node->data, toFind, node->size)) {
-            return index;
+    CD9LIST_COUNT(list, operations[CD9LIST_OP_SORT], 1);
+
+    if(!cd9list_unshare(list)) {
+        return;
+    }
+
+    CD9Node *stop = cd9list_getNode(list, list->length - 1);
+
+#ifdef CD9LIST_STATS
+    size_t comparisons = cd9list_globalStats.comparisons;
+#endif
+
+    list->nodes   = cd9list_mergeSort(list->nodes, stop, cmp); 
+
+#ifdef CD9LIST_STATS
+    list->stats.comparisons += cd9list_globalStats.comparisons - comparisons;
+#endif
+}
+
+/**
+ * @brief Helper function that returns the nodes of `list` in a form `owner`
+ *        can take. The nodes themselves are returned if `owner` can free
+ *        them, otherwise they are copied to the memory of `owner`.
+ *
+ * @param failed Set to `true` if malloc failed.
+ *
+ * @return CD9Node * The chain of nodes.
+ */
+CD9Node *cd9list_adoptNodes(CD9List *owner, CD9List *list, bool *failed)
+{
+    if(cd9list_sameOwner(owner, list->arena, &list->allocator,
+                         list->elementSize, list->refCounted,
+                         list->payloadHeaders)) {
+        // The nodes kept inside a small list can't move to another list.
+        if(list != owner && !cd9list_spill(list)) {
+            *failed = true;
+            return NULL;
         }
+
+        return list->nodes;
     }
-    return -1;
+
+    CD9Node *nodes = NULL;
+    CD9Node *tail  = NULL;
+
+    CD9FOREACH_(list, node) {
+        CD9Node *copy = cd9list_createListNode(owner, node->data,
+                                               cd9list_nodeSize(list, node));
+
+        if(copy == NULL) { // Malloc failed.
+            cd9list_deleteChain(owner, nodes);
+            *failed = true;
+
+            return NULL;
+        }
+
+        if(tail == NULL) {
+            nodes = copy;
+        }
+        else {
+            tail->next = copy;
+        }
+
+        tail = copy;
+    }
+
+    return nodes;
 }
 
-int cd9list_findByAddress(void *self, const void *data) 
+/**
+ * @brief Helper function that empties `list` once its nodes were taken by
+ *        `cd9list_adoptNodes`. The nodes are freed if they were copied.
+ */
+void cd9list_giveNodes(CD9List *list, CD9Node *adopted)
 {
-    CD9List *list = (CD9List *)self;
+    if(adopted != list->nodes) {
+        cd9list_deleteChain(list, list->nodes);
+    }
 
-    return list->find(list, data, callbacks_findByAddressCmp);
+    list->nodes  = NULL;
+    list->length = 0;
+}
+
+int cd9list_mergeSorted(CD9List            *list1,
+                        CD9List            *list2,
+                        CD9CompareCallback cmp)
+{
+    bool failed = false;
+
+    if(!cd9list_unshare(list1) || !cd9list_unshare(list2)) {
+        return 0;
+    }
+
+    CD9Node *nodes = cd9list_adoptNodes(list1, list2, &failed);
+    if(failed) {
+        return 0;
+    }
+
+    if(list1->nodes == NULL) {
+        list1->nodes = nodes;
+    }
+    else if(nodes != NULL) {
+#ifdef CD9LIST_STATS
+        size_t comparisons = cd9list_globalStats.comparisons;
+#endif
+
+        list1->nodes = cd9list_merge(list1->nodes, nodes, cmp);
+
+#ifdef CD9LIST_STATS
+        list1->stats.comparisons += cd9list_globalStats.comparisons -
+                                    comparisons;
+#endif
+    }
+
+    list1->length += list2->length;
+    cd9list_giveNodes(list2, nodes);
+
+    return 1;
+}
+
+/**
+ * @brief An entry of the heap used by `cd9list_mergeK`, the next node of
+ *        the list `index`.
+ */
+typedef struct CD9MergeHead {
+    CD9Node *node;
+    size_t index;
+} CD9MergeHead;
+
+/**
+ * @brief Helper function that tells if `a` should come out of the heap
+ *        before `b`. The ties go to the first list, so the merge is stable.
+ */
+bool cd9list_headBefore(CD9List            *list,
+                        const CD9MergeHead *a,
+                        const CD9MergeHead *b,
+                        CD9CompareCallback cmp)
+{
+    CD9LIST_COUNT(list, comparisons, 1);
+
+    int order = cmp(a->node->data, b->node->data);
+
+    return order < 0 || (order == 0 && a->index < b->index);
+}
+
+/**
+ * @brief Helper function that moves the entry `i` of the heap down to its
+ *        place.
+ */
+void cd9list_siftDown(CD9List            *list,
+                      CD9MergeHead       *heap,
+                      size_t             count,
+                      size_t             i,
+                      CD9CompareCallback cmp)
+{
+    for(;;) {
+        size_t first = i;
+        size_t left  = 2 * i + 1;
+        size_t right = left + 1;
+
+        if(left < count &&
+           cd9list_headBefore(list, &heap[left], &heap[first], cmp)) {
+            first = left;
+        }
+
+        if(right < count &&
+           cd9list_headBefore(list, &heap[right], &heap[first], cmp)) {
+            first = right;
+        }
+
+        if(first == i) {
+            return;
+        }
+
+        CD9MergeHead head = heap[i];
+
+        heap[i]     = heap[first];
+        heap[first] = head;
+        i           = first;
+    }
+}
+
+int cd9list_mergeK(CD9List **lists, size_t k, CD9CompareCallback cmp)
+{
+    if(k < 2) {
+        return (k == 0) ? 1 : cd9list_unshare(lists[0]);
+    }
+
+    CD9List *list      = lists[0];
+    CD9MergeHead *heap = malloc(k * sizeof(CD9MergeHead));
+    CD9Node **adopted  = malloc(k * sizeof(CD9Node *));
+
+    if(heap == NULL || adopted == NULL) { // Malloc failed.
+        free(heap);
+        free(adopted);
+        return 0;
+    }
+
+    bool failed = false;
+    size_t i;
+
+    for(i = 0; i < k && !failed; i++) {
+        if(!cd9list_unshare(lists[i])) {
+            break;
+        }
+
+        adopted[i] = cd9list_adoptNodes(list, lists[i], &failed);
+    }
+
+    if(i < k || failed) {
+        // Free the copies made so far, the lists were not changed.
+        for(size_t j = 0; j < i; j++) {
+            if(adopted[j] != lists[j]->nodes) {
+                cd9list_deleteChain(list, adopted[j]);
+            }
+        }
+
+        free(heap);
+        free(adopted);
+        return 0;
+    }
+
+    size_t count  = 0;
+    size_t length = 0;
+
+    for(i = 0; i < k; i++) {
+        if(adopted[i] != NULL) {
+            heap[count++] = (CD9MergeHead){adopted[i], i};
+        }
+
+        length += lists[i]->length;
+    }
+
+    for(i = count / 2; i-- > 0;) {
+        cd9list_siftDown(list, heap, count, i, cmp);
+    }
+
+    CD9Node *nodes = NULL;
+    CD9Node *tail  = NULL;
+
+    while(count > 0) {
+        CD9Node *node = heap[0].node;
+
+        if(tail == NULL) {
+            nodes = node;
+        }
+        else {
+            tail->next = node;
+        }
+
+        tail = node;
+
+        // The next node of the same list takes its place, the heap only
+        // shrinks when a list runs out.
+        if(node->next != NULL) {
+            CD9PREFETCH_HINT(node->next);
+            heap[0].node = node->next;
+        }
+        else {
+            heap[0] = heap[--count];
+        }
+
+        cd9list_siftDown(list, heap, count, 0, cmp);
+    }
+
+    for(i = 1; i < k; i++) {
+        cd9list_giveNodes(lists[i], adopted[i]);
+    }
+
+    list->nodes  = nodes;
+    list->length = length;
+
+    free(heap);
+    free(adopted);
+
+    return 1;
+}
+
+/**
+ * @brief An entry of the heap used by `cd9list_topK`, a node and its index
+ *        in the list.
+ */
+typedef struct CD9RankedNode {
+    const CD9Node *node;
+    size_t index;
+} CD9RankedNode;
+
+/**
+ * @brief Helper function that tells if `a` comes after `b` in the result of
+ *        `cd9list_topK`. The ties are broken by the index, so the result is
+ *        stable.
+ */
+bool cd9list_rankedAfter(const CD9RankedNode *a,
+                         const CD9RankedNode *b,
+                         CD9CompareCallback  cmp)
+{
+    int order = cmp(a->node->data, b->node->data);
+
+    return order > 0 || (order == 0 && a->index > b->index);
+}
+
+/**
+ * @brief Helper function that moves the entry `i` of the heap of
+ *        `cd9list_topK` down to its place. The last element of the result is
+ *        at the top of the heap.
+ */
+void cd9list_siftDownRanked(CD9RankedNode      *heap,
+                            size_t             count,
+                            size_t             i,
+                            CD9CompareCallback cmp)
+{
+    for(;;) {
+        size_t last  = i;
+        size_t left  = 2 * i + 1;
+        size_t right = left + 1;
+
+        if(left < count &&
+           cd9list_rankedAfter(&heap[left], &heap[last], cmp)) {
+            last = left;
+        }
+
+        if(right < count &&
+           cd9list_rankedAfter(&heap[right], &heap[last], cmp)) {
+            last = right;
+        }
+
+        if(last == i) {
+            return;
+        }
+
+        CD9RankedNode entry = heap[i];
+
+        heap[i]    = heap[last];
+        heap[last] = entry;
+        i          = last;
+    }
 }
 
-int cd9list_findByValue(void *self, const void *data)
-{
-    CD9List *list = (CD9List *)self;
+CD9List *cd9list_topK(const CD9List *list, size_t k, CD9CompareCallback cmp)
+{
+    CD9List *result = cd9list_createListLike(list);
+    if(result == NULL) {
+        return NULL;
+    }
+
+    k = (k < list->length) ? k : list->length;
+
+    if(k == 0) {
+        return result;
+    }
+
+    CD9RankedNode *heap = malloc(k * sizeof(CD9RankedNode));
+    if(heap == NULL) { // Malloc failed.
+        cd9list_deleteList(result);
+        return NULL;
+    }
+
+    size_t count = 0;
+
+    CD9FOREACH_(list, node, index) {
+        CD9RankedNode entry = {node, index};
+
+        if(count < k) {
+            heap[count++] = entry;
+
+            if(count == k) {
+                for(size_t i = k / 2; i-- > 0;) {
+                    cd9list_siftDownRanked(heap, k, i, cmp);
+                }
+            }
+        }
+        else if(cd9list_rankedAfter(&heap[0], &entry, cmp)) {
+            // The node replaces the last element of the result so far.
+            heap[0] = entry;
+            cd9list_siftDownRanked(heap, k, 0, cmp);
+        }
+    }
+
+    // Taking the top of the heap gives the result from its end, so the nodes
+    // are prepended.
+    while(count > 0) {
+        const CD9Node *node = heap[0].node;
+        size_t size         = cd9list_nodeSize(list, node);
+        CD9Node *copy       = cd9list_createListNode(result, node->data,
+                                                     size);
+
+        if(copy == NULL) { // Malloc failed.
+            free(heap);
+            cd9list_deleteList(result);
+            return NULL;
+        }
+
+        copy->next    = result->nodes;
+        result->nodes = copy;
+        result->length++;
+
+        heap[0] = heap[--count];
+        cd9list_siftDownRanked(heap, count, 0, cmp);
+    }
 
-    return list->find(list, data, callbacks_findByValueCmp);
+    free(heap);
+
+    return result;
 }
 
-/**
- * @brief Helper function used by `cd9list_mergeSort` in order to combine 2
- *        sublists.
- *
- * @param part1 Pointer to the first sublist.
- * @param part2 Pointer to the second sublist.
- * @param cmp The comparison function, see \ref CD9List::sort for more details. 
- *
- * @return CD9Node * A pointer to the merged version of the 2 parts.
- */
-CD9Node *cd9list_merge(CD9Node *part1, 
-                       CD9Node *part2, 
-                       int (*cmp)(const void *, const void *))
+void *cd9list_nthElement(const CD9List      *list,
+                         size_t             n,
+                         CD9CompareCallback cmp)
 {
-    CD9Node *temp;
+    if(n >= list->length) {
+        return NULL;
+    }
 
-    if(cmp(part1->data, part2->data) <= 0) {
-        temp  = part1;
-        part1 = part1->next; 
+    const CD9Node **nodes = malloc(list->length * sizeof(CD9Node *));
+    if(nodes == NULL) { // Malloc failed.
+        return NULL;
     }
-    else {
-        temp  = part2;
-        part2 = part2->next;
+
+    CD9FOREACH_(list, node, index) {
+        nodes[index] = node;
     }
 
-    CD9Node *current = temp;
+    size_t low  = 0;
+    size_t high = list->length;
 
-    while(part1 != NULL && part2 != NULL) {
-        if(cmp(part1->data, part2->data) <= 0) {
-            current->next = part1;
-            part1         = part1->next; 
+    // Quickselect with a 3 way partition, so the runs of equal elements
+    // don't make it quadratic: [low, lt) < pivot, [lt, gt) == pivot and
+    // [gt, high) > pivot.
+    for(;;) {
+        const void *pivot = nodes[low + (high - low) / 2]->data;
+        size_t lt         = low;
+        size_t gt         = high;
+        size_t i          = low;
+
+        while(i < gt) {
+            int order = cmp(nodes[i]->data, pivot);
+
+            if(order < 0) {
+                const CD9Node *node = nodes[i];
+
+                nodes[i++]  = nodes[lt];
+                nodes[lt++] = node;
+            }
+            else if(order > 0) {
+                const CD9Node *node = nodes[i];
+
+                nodes[i]    = nodes[--gt];
+                nodes[gt]   = node;
+            }
+            else {
+                i++;
+            }
+        }
+
+        if(n < lt) {
+            high = lt;
+        }
+        else if(n >= gt) {
+            low = gt;
         }
         else {
-            current->next = part2;
-            part2         = part2->next;
+            break;
         }
-        current = current->next;
     }
 
-    if(part1 != NULL) {
-        current->next = part1;
-    }
+    void *data = nodes[n]->data;
 
-    if(part2 != NULL) {
-        current->next = part2;
-    }
+    free(nodes);
 
-    return temp;
-}  
+    return data;
+}
 
-/**
- * @brief This is a helper function, its main purpose is to return a pointer
- *        to the node of the list refered by `start` and `stop`. We can't use
- *        `cd9list_getNode` since it requires a pointer to the list and we 
- *        don't have access to it inside `cd9list_mergeSort`.
- * 
- * @param start The starting node of the list.
- * @param stop Pointer to the end of the list.
- *
- * @return CD9Node * A pointer to the middle node of the list delimited by
- *         `start` and `stop`.
- */ 
-CD9Node *cd9list_getMidNode(CD9Node *start, CD9Node *stop)
+CD9List *cd9list_createList()
 {
-    CD9Node *front = start;
-    CD9Node *back  = start->next;
+    return cd9list_createListWithAllocator(NULL);
+}
 
-    while(back != stop) {
-        back = back->next;
-        if(back != stop) {
-            back  = back->next;
-            front = front->next;
-        }
-    }
+/**
+ * @brief A small list, allocated at once with its inline slots.
+ */
+typedef struct CD9SmallList {
+    CD9List list;
+    CD9InlineSlots slots;
+} CD9SmallList;
 
-    return front;
+/**
+ * @brief Helper function that returns the number of bytes allocated for the
+ *        list object.
+ */
+size_t cd9list_objectSize(const CD9List *list)
+{
+    return (list->inlineSlots != NULL) ? sizeof(CD9SmallList) :
+                                         sizeof(CD9List);
 }
 
 /**
- * @brief This is the function called by `cd9list_sort` in order to sort a 
- *        list. It implements the merge sort algorithm.
- * 
- * @param start A pointer to the starting node of the list that should be
- *        sorted.
- * @param stop A pointer to the stoping node of the list.
- * @param cmp The comparison function. See \ref CD9List::sort for more details.
- *
- * @return CD9Node * It returns a pointer to the sorted version of the list.
- */ 
-CD9Node *cd9list_mergeSort(CD9Node *start,
-                           CD9Node *stop,
-                           int (*cmp)(const void *, const void *))
+ * @brief Helper function that creates a list, with inline slots if `small`
+ *        is `true`.
+ */
+CD9List *cd9list_createListOfKind(const CD9Allocator *allocator, bool small)
 {
-    if(start == stop) {
-        start->next = NULL;
-        return start;
-    }
-
-    CD9Node *midNode     = cd9list_getMidNode(start, stop->next);
-    CD9Node *midNodeNext = midNode->next;
-    
-    CD9Node *part1 = cd9list_mergeSort(start, midNode, cmp);
-    CD9Node *part2 = cd9list_mergeSort(midNodeNext, stop, cmp);
+    CD9Allocator defaultAllocator = {
+        cd9list_mallocAlloc, cd9list_mallocFree, NULL
+    };
 
-    return cd9list_merge(part1, part2, cmp);
-}    
+    if(allocator == NULL) {
+        allocator = &defaultAllocator;
+    }
 
-void cd9list_sort(void *self, int (*cmp)(const void *, const void *))
-{
-    CD9List *list = (CD9List *)self;
-    CD9Node *stop = cd9list_getNode(list, list->length - 1);
+    size_t objectSize = small ? sizeof(CD9SmallList) : sizeof(CD9List);
+    CD9List *list     = allocator->alloc(allocator->ctx, objectSize);
+    if(list == NULL) { // The allocation failed.
+        return NULL; 
+    }
 
-    list->nodes   = cd9list_mergeSort(list->nodes, stop, cmp); 
-}
+    list->inlineSlots    = NULL;
+    list->elementSize    = 0;
+    list->refCounted     = false;
+    list->payloadHeaders = false;
 
-CD9List *cd9list_createList()
-{
-    CD9List *list = malloc(sizeof(CD9List));
-    if(list == NULL) { // Malloc failed.
-        return NULL; 
+    if(small) {
+        list->inlineSlots       = &((CD9SmallList *)list)->slots;
+        list->inlineSlots->used = 0;
     }
     
-    list->length = 0;
-    list->nodes  = NULL;
+    list->length      = 0;
+    list->nodes       = NULL;
+    list->arena       = NULL;
+    list->allocator   = *allocator;
+    list->copyOnWrite = false;
+    list->shared      = NULL;
+    list->sharedNodes = NULL;
+    list->ownLength   = 0;
+    list->hashing     = false;
+
+#ifdef CD9LIST_STATS
+    memset(&list->stats, 0, sizeof(CD9ListStats));
+    CD9LIST_COUNT(list, bytesAllocated, objectSize);
+#endif
 
     // Now bind the functions;
     list->append         = cd9list_append;
@@ -488,8 +3121,65 @@ CD9List *cd9list_createList()
     return list;
 }
 
-void cd9list_deleteNode(CD9Node *node)
+CD9List *cd9list_createListWithAllocator(const CD9Allocator *allocator)
+{
+    return cd9list_createListOfKind(allocator, false);
+}
+
+CD9List *cd9list_createListOfSize(size_t elementSize)
+{
+    return cd9list_createListOfSizeWithAllocator(elementSize, NULL);
+}
+
+CD9List *cd9list_createListOfSizeWithAllocator(size_t             elementSize,
+                                               const CD9Allocator *allocator)
+{
+    CD9List *list = cd9list_createListOfKind(allocator, false);
+    if(list == NULL) { // The allocation failed.
+        return NULL;
+    }
+
+    list->elementSize = elementSize;
+
+    return list;
+}
+
+CD9List *cd9list_createRefCountedList()
+{
+    return cd9list_createRefCountedListWithAllocator(NULL);
+}
+
+CD9List *cd9list_createRefCountedListWithAllocator(
+    const CD9Allocator *allocator)
+{
+    CD9List *list = cd9list_createListOfKind(allocator, false);
+    if(list == NULL) { // The allocation failed.
+        return NULL;
+    }
+
+    list->refCounted     = true;
+    list->payloadHeaders = true;
+
+    return list;
+}
+
+CD9List *cd9list_createSmallList()
+{
+    return cd9list_createListOfKind(NULL, true);
+}
+
+CD9List *cd9list_createSmallListWithAllocator(const CD9Allocator *allocator)
+{
+    return cd9list_createListOfKind(allocator, true);
+}
+
+void cd9list_deleteNode(CD9List *list, CD9Node *node)
 {
+    if(list != NULL) {
+        cd9list_deleteListNode(list, node);
+        return;
+    }
+
     if(node->size != SIZE_ZERO) {
         // Free the data allocated by cd9list_insertCopy.
         free(node->data);    
@@ -498,17 +3188,215 @@ void cd9list_deleteNode(CD9Node *node)
     free(node);
 }
 
+CD9List *cd9list_createListOnArena(CD9Arena *arena)
+{
+    CD9List *list = cd9list_createList();
+    if(list == NULL) {
+        return NULL;
+    }
+
+    list->arena = cd9arena_retain(arena);
+
+    return list;
+}
+
+CD9List *cd9list_createArenaList(size_t blockSize)
+{
+    CD9Arena *arena = cd9arena_create(blockSize);
+    if(arena == NULL) {
+        return NULL;
+    }
+
+    CD9List *list = cd9list_createListOnArena(arena);
+
+    // From now on the list holds the only reference.
+    cd9arena_release(arena);
+
+    return list;
+}
+
+int cd9list_compact(CD9List *list)
+{
+    if(list->nodes == NULL) {
+        return 1; // Nothing to move.
+    }
+
+    size_t blockSize = 0;
+
+    CD9FOREACH_(list, node) {
+        size_t size    = cd9list_nodeSize(list, node);
+        size_t payload = (size != SIZE_ZERO) ?
+                         cd9list_payloadSize(list, size) : 0;
+
+        blockSize += (list->elementSize != 0) ?
+                     cd9arena_align(sizeof(CD9PackedNode) + payload) :
+                     cd9arena_align(sizeof(CD9Node)) +
+                     cd9arena_align(payload);
+    }
+
+    // A single block that fits every node and every copy.
+    CD9Arena *arena = cd9arena_create(blockSize);
+    if(arena == NULL) {
+        return 0;
+    }
+
+    // The new nodes are allocated the way the list allocates its nodes, but
+    // from the new arena.
+    CD9Arena *oldArena = list->arena;
+    CD9Node *nodes     = NULL;
+    CD9Node *tail      = NULL;
+
+    list->arena = arena;
+
+    CD9FOREACH_(list, node) {
+        CD9Node *moved = cd9list_createHeapNode(list, node->data,
+                                                cd9list_nodeSize(list, node));
+
+        if(moved == NULL) {
+            // The list was not touched yet.
+            list->arena = oldArena;
+            cd9arena_release(arena);
+
+            return 0;
+        }
+
+        // The hashes stay, even if the mode was turned off since.
+        size_t hash = cd9list_nodeHash(list, node);
+
+        if(hash != 0) {
+            cd9list_payloadHeader(moved)->hash = hash;
+        }
+
+        if(tail == NULL) {
+            nodes = moved;
+        }
+        else {
+            tail->next = moved;
+        }
+
+        tail = moved;
+    }
+
+    // The next appends shouldn't request blocks as big as the whole list.
+    arena->blockSize = CD9ARENA_DEFAULT_BLOCK_SIZE;
+
+    // The old nodes are freed the way they were allocated.
+    list->arena = oldArena;
+
+    if(list->arena != NULL) {
+        cd9arena_release(list->arena);
+    }
+    else {
+        CD9Node *node = list->nodes;
+
+        while(node != list->sharedNodes) {
+            CD9Node *next = node->next;
+
+            cd9list_deleteListNode(list, node);
+            node = next;
+        }
+    }
+
+    if(list->shared != NULL) {
+        cd9list_releaseShared(list->shared);
+    }
+
+    // Every copy moved out of the slots kept inside the list, they are all
+    // free again.
+    if(list->inlineSlots != NULL) {
+        list->inlineSlots->used = 0;
+    }
+
+    // The list takes the only reference to the new arena.
+    list->arena       = arena;
+    list->nodes       = nodes;
+    list->shared      = NULL;
+    list->sharedNodes = NULL;
+    list->ownLength   = 0;
+
+    return 1;
+}
+
+void cd9list_deleteListNode(CD9List *list, CD9Node *node)
+{
+    if(cd9list_isInline(list, node)) {
+        // The slot is simply given back, the copy lives in it.
+        list->inlineSlots->used &= ~(1u << (node - list->inlineSlots->nodes));
+        return;
+    }
+
+    if(list->elementSize != 0) {
+        cd9list_release(list, node, sizeof(CD9PackedNode) +
+                        cd9list_payloadSize(list, list->elementSize));
+        return;
+    }
+
+    if(list->payloadHeaders && node->size != SIZE_ZERO) {
+        CD9PayloadHeader *header = cd9list_payloadHeader(node);
+
+        // The copy stays as long as another node uses it.
+        if(--header->refs == 0) {
+            cd9list_release(list, header,
+                            cd9list_payloadSize(list, node->size));
+        }
+
+        cd9list_release(list, node, sizeof(CD9Node));
+        return;
+    }
+
+    if(node->size != SIZE_ZERO) {
+        cd9list_release(list, node->data, node->size);
+    }
+
+    cd9list_release(list, node, sizeof(CD9Node));
+}
+
 void cd9list_deleteList(CD9List *list)
 {
-    CD9Node *phead = list->nodes;
-    CD9Node *tmp;
+    CD9Allocator allocator = list->allocator;
 
-    while(phead != NULL) {
-        tmp = phead->next;
-        cd9list_deleteNode(phead);
-        phead = tmp;
+    if(list->arena != NULL) {
+        // There is no need to walk the nodes, they all live in the arena.
+        cd9arena_release(list->arena);
     }
+    else {
+        CD9Node *phead = list->nodes;
+        CD9Node *tmp;
+
+        // The shared nodes are freed with the shared chain.
+        while(phead != list->sharedNodes) {
+            CD9PREFETCH_HINT(phead);
+
+            tmp = phead->next;
+            cd9list_deleteListNode(list, phead);
+            phead = tmp;
+        }
+    }
+
+    if(list->shared != NULL) {
+        cd9list_releaseShared(list->shared);
+    }
+
+#ifdef CD9LIST_STATS
+    cd9list_globalStats.bytesFreed += cd9list_objectSize(list);
+#endif
 
-    free(list);
+    allocator.free(allocator.ctx, list, cd9list_objectSize(list));
 }
 
+#ifdef CD9LIST_STATS
+const CD9ListStats *cd9list_getStats(const CD9List *list)
+{
+    return &list->stats;
+}
+
+const CD9ListStats *cd9list_getGlobalStats()
+{
+    return &cd9list_globalStats;
+}
+
+void cd9list_resetGlobalStats()
+{
+    memset(&cd9list_globalStats, 0, sizeof(CD9ListStats));
+}
+#endif
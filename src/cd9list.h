@@ -2,9 +2,12 @@
 #define CD9LIST_H__
 
 #include <stdio.h>
+#include <stddef.h>
 #include "va_numargs.h"
 #include "macro_dispatcher.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include "cd9arena.h"
 
 /**
  * @brief Use to express the fact that the size of a node is 0.
@@ -29,6 +32,143 @@ typedef bool (*CD9FindCallback)(const void *data,
                                 const void *toFind, 
                                 size_t     size);
 
+/**
+ * @brief The maximum number of elements passed at once to a
+ *        \ref CD9BatchFindCallback.
+ */
+#define CD9LIST_FIND_BATCH 64
+
+/**
+ * @brief This is the signature of the callback of `cd9list_findBatched` and
+ *        `cd9list_filterBatched`. It works like \ref CD9FindCallback, but it
+ *        gets up to \ref CD9LIST_FIND_BATCH elements at every call, so a
+ *        cheap comparison isn't dominated by the cost of the call and it can
+ *        handle the elements together.
+ *
+ * @param items The data of the elements, in the order of the list.
+ * @param sizes The sizes of the elements.
+ * @param n The number of elements, never `0`.
+ * @param key The data you want to find.
+ * @param matches Set `matches[i]` to a value other than `0` if the element
+ *        `i` is equal to `key` and to `0` otherwise.
+ *
+ * @return void It doesn't return anything.
+ */
+typedef void (*CD9BatchFindCallback)(const void *const *items,
+                                     const size_t      *sizes,
+                                     size_t            n,
+                                     const void        *key,
+                                     uint8_t           *matches);
+
+/**
+ * @brief This is the signature of the comparator used by the functions that
+ *        need to order the elements of a list, for example 
+ *        `cd9sortedlist_createList`.
+ *
+ * @param a The first value.
+ * @param b The second value.
+ *
+ * @return int A value less than `0` if `a` is less than `b`, `0` if they are
+ *         equal and a value bigger than `0` if `a` is bigger than `b`.
+ */
+typedef int (*CD9CompareCallback)(const void *a, const void *b);
+
+/**
+ * @brief This is the signature of the hash functions used by
+ *        `cd9list_unique` and `cd9list_countDistinct`. Equal elements must
+ *        have the same hash.
+ *
+ * @param data The data of an element.
+ * @param size The size of the element, `0` if the list stores its address.
+ *
+ * @return size_t The hash of the element.
+ */
+typedef size_t (*CD9HashCallback)(const void *data, size_t size);
+
+/**
+ * @brief This is the signature of the functions that tell if 2 elements are
+ *        equal, see `cd9list_unique`.
+ *
+ * @param a The data of the first element.
+ * @param sizeA The size of the first element.
+ * @param b The data of the second element.
+ * @param sizeB The size of the second element.
+ *
+ * @return bool It returns `true` if the elements are equal.
+ */
+typedef bool (*CD9EqualCallback)(const void *a, size_t sizeA,
+                                 const void *b, size_t sizeB);
+
+/**
+ * @brief An allocator used by a list for its nodes, for the copies made by
+ *        the *Copy functions and for the list itself. The lists created from
+ *        a list, for example by `copy` or `filter`, use the same allocator.
+ *
+ * @var CD9Allocator::alloc Called to allocate `size` bytes. It should return
+ *      `NULL` if the allocation fails.
+ * @var CD9Allocator::free Called to free a block returned by `alloc`. `size`
+ *      is the size that was requested when the block was allocated.
+ * @var CD9Allocator::ctx This value will be passed to `alloc` and `free` at
+ *      every call.
+ */
+typedef struct CD9Allocator {
+    void *(*alloc)(void *ctx, size_t size);
+    void (*free)(void *ctx, void *memory, size_t size);
+    void *ctx;
+} CD9Allocator;
+
+#ifdef CD9LIST_STATS
+/**
+ * @brief The operations counted by the stats of a list. The stats are
+ *        compiled in only when `CD9LIST_STATS` is defined, both for the
+ *        library and for the code that includes this header, for example
+ *        `make FEATURES=-DCD9LIST_STATS`.
+ */
+typedef enum CD9ListOperation {
+    CD9LIST_OP_APPEND,
+    CD9LIST_OP_PREPEND,
+    CD9LIST_OP_INSERT,
+    CD9LIST_OP_GET,
+    CD9LIST_OP_POP,
+    CD9LIST_OP_POPLEFT,
+    CD9LIST_OP_REMOVE,
+    CD9LIST_OP_FIND,
+    CD9LIST_OP_FILTER,
+    CD9LIST_OP_COPY,
+    CD9LIST_OP_SLICE,
+    CD9LIST_OP_CONCAT,
+    CD9LIST_OP_REVERSE,
+    CD9LIST_OP_SORT,
+    CD9LIST_OP_COUNT
+} CD9ListOperation;
+
+/**
+ * @brief The counters kept for every list and for all the lists together.
+ *
+ * @var CD9ListStats::operations The number of calls of every operation,
+ *      indexed by \ref CD9ListOperation. The *Copy variants and the find
+ *      and filter wrappers are counted with the operation they wrap.
+ * @var CD9ListStats::nodesVisited The number of nodes walked by 
+ *      `cd9list_getNode`.
+ * @var CD9ListStats::callbacks The number of times a comparator was called
+ *      by `find` and the filter functions.
+ * @var CD9ListStats::comparisons The number of comparisons made by
+ *      `cd9list_merge` while sorting.
+ * @var CD9ListStats::bytesAllocated The number of bytes allocated for the
+ *      list, its nodes and its copies.
+ * @var CD9ListStats::bytesFreed The number of bytes freed. Memory carved from
+ *      an arena is not counted, since it is freed with the arena.
+ */
+typedef struct CD9ListStats {
+    size_t operations[CD9LIST_OP_COUNT];
+    size_t nodesVisited;
+    size_t callbacks;
+    size_t comparisons;
+    size_t bytesAllocated;
+    size_t bytesFreed;
+} CD9ListStats;
+#endif
+
 /**
  * @brief A node is an object in memory that holds the a pointer to the actual
  *        data and a pointer to the next element in the list.  
@@ -37,7 +177,9 @@ typedef bool (*CD9FindCallback)(const void *data,
  * @var CD9Node::next A pointer to the next node in the list.
  * @var CD9Node::size If the user stored a copy of the data in the list, for
  *      example using `cd9list_appendCopy` this memeber will store the number
- *      of bytes ocupied by the copy.   
+ *      of bytes ocupied by the copy. The nodes of a list created with
+ *      `cd9list_createListOfSize` don't have it, see \ref CD9PackedNode and
+ *      `cd9list_nodeSize`.
  *
  */  
 typedef struct CD9Node {
@@ -46,16 +188,155 @@ typedef struct CD9Node {
     size_t size;
 } CD9Node;
 
+/**
+ * @brief The part of a node stored by the lists created with
+ *        `cd9list_createListOfSize`: only `data` and `next`, the size of the
+ *        copy is the element size of the list. The copy is stored right
+ *        after it, in the same allocation, aligned like the memory returned
+ *        by `malloc`.
+ */
+typedef union CD9PackedNode {
+    unsigned char node[offsetof(CD9Node, size)];
+    long double alignment;
+} CD9PackedNode;
+
+/**
+ * @brief The header stored in front of the copies of the lists that keep
+ *        one, see \ref CD9List::payloadHeaders.
+ *
+ * @var CD9PayloadHeader::refs The number of nodes that use the copy, see
+ *      `cd9list_createRefCountedList`.
+ * @var CD9PayloadHeader::hash The hash of the copy, see
+ *      `cd9list_setHashing`, or `0` if it wasn't computed.
+ */
+typedef struct CD9PayloadHeader {
+    size_t refs;
+    size_t hash;
+} CD9PayloadHeader;
+
+/**
+ * @brief The room taken by a \ref CD9PayloadHeader, the copy right after it
+ *        is aligned like the memory returned by `malloc`.
+ */
+typedef union CD9PayloadRoom {
+    CD9PayloadHeader header;
+    long double alignment;
+} CD9PayloadRoom;
+
+/**
+ * @brief A chain of nodes shared by lists in copy-on-write mode, see
+ *        `cd9list_setCopyOnWrite`. The chain is freed when the last list
+ *        that shares it lets it go.
+ *
+ * @var CD9SharedNodes::refs The number of lists that share the chain.
+ * @var CD9SharedNodes::nodes The first node of the chain, the chain runs to
+ *      the end of the list it was taken from.
+ * @var CD9SharedNodes::arena The arena the nodes were allocated from or
+ *      `NULL`, the chain holds a reference to it.
+ * @var CD9SharedNodes::allocator The allocator the nodes were allocated
+ *      with when there is no arena.
+ * @var CD9SharedNodes::elementSize The element size of the list the nodes
+ *      were taken from, see \ref CD9List::elementSize.
+ * @var CD9SharedNodes::refCounted It is `true` if the copies of the nodes
+ *      are reference counted, see \ref CD9List::refCounted.
+ * @var CD9SharedNodes::payloadHeaders It is `true` if the copies of the
+ *      nodes have a header, see \ref CD9List::payloadHeaders.
+ */
+typedef struct CD9SharedNodes {
+    size_t refs;
+    CD9Node *nodes;
+    CD9Arena *arena;
+    CD9Allocator allocator;
+    size_t elementSize;
+    bool refCounted;
+    bool payloadHeaders;
+} CD9SharedNodes;
+
+/**
+ * @brief The number of elements a small list keeps inside the list object,
+ *        see `cd9list_createSmallList`.
+ */
+#define CD9LIST_INLINE_NODES 4
+
+/**
+ * @brief The biggest copy a small list keeps inside the list object.
+ */
+#define CD9LIST_INLINE_SIZE 16
+
+/**
+ * @brief The room for a copy kept inside a small list, aligned like the
+ *        memory returned by `malloc`.
+ */
+typedef union CD9InlineData {
+    unsigned char bytes[CD9LIST_INLINE_SIZE];
+    long double alignment;
+} CD9InlineData;
+
+/**
+ * @brief The nodes and copies kept inside a small list. They are allocated
+ *        with the list, right after it.
+ *
+ * @var CD9InlineSlots::used The bit `i` is set if the slot `i` is in use.
+ * @var CD9InlineSlots::nodes The nodes of the slots.
+ * @var CD9InlineSlots::data The copies of the slots.
+ */
+typedef struct CD9InlineSlots {
+    unsigned used;
+    CD9Node nodes[CD9LIST_INLINE_NODES];
+    CD9InlineData data[CD9LIST_INLINE_NODES];
+} CD9InlineSlots;
+
 /**
  * @brief This structure is used to group logic of the list.
  *
  * @var CD9List::length The number of the elements in the list.
  * @var CD9List::nodes Pointer to the first node in the list.
+ * @var CD9List::arena The arena the nodes of the list are allocated from or
+ *      `NULL` if they are allocated with `allocator`.
+ * @var CD9List::allocator The allocator used by the list, see 
+ *      \ref CD9Allocator.
+ * @var CD9List::copyOnWrite If it is `true`, `copy`, `slice` and `concat`
+ *      share the nodes instead of copying them, see
+ *      `cd9list_setCopyOnWrite`.
+ * @var CD9List::shared The chain the list shares with other lists or `NULL`.
+ * @var CD9List::sharedNodes The first node of the list that belongs to
+ *      `shared`, every node after it is shared as well.
+ * @var CD9List::ownLength The number of nodes before `sharedNodes`, they
+ *      belong to the list alone.
+ * @var CD9List::hashing If it is `true`, the copies are stored with their
+ *      hash, see `cd9list_setHashing`.
+ * @var CD9List::inlineSlots The nodes kept inside the list or `NULL` if it
+ *      is not a small list, see `cd9list_createSmallList`.
+ * @var CD9List::elementSize The size of every element of the list or `0`.
+ *      If it is not `0`, every node is a \ref CD9PackedNode, see
+ *      `cd9list_createListOfSize`.
+ * @var CD9List::refCounted If it is `true`, the copies are reference
+ *      counted and shared by the lists derived from the list, see
+ *      `cd9list_createRefCountedList`.
+ * @var CD9List::payloadHeaders If it is `true`, the copies that are not
+ *      kept inside the list are stored after a \ref CD9PayloadHeader. Only
+ *      the lists whose copies are reference counted or hashed have them.
+ * @var CD9List::stats The counters of the list, they exist only when 
+ *      `CD9LIST_STATS` is defined.
  *
  */ 
 typedef struct CD9List {
     size_t length;
     CD9Node *nodes;   
+    CD9Arena *arena;
+    CD9Allocator allocator;
+    bool copyOnWrite;
+    CD9SharedNodes *shared;
+    CD9Node *sharedNodes;
+    size_t ownLength;
+    bool hashing;
+    CD9InlineSlots *inlineSlots;
+    size_t elementSize;
+    bool refCounted;
+    bool payloadHeaders;
+#ifdef CD9LIST_STATS
+    CD9ListStats stats;
+#endif
     
     /**
      * @brief Call this function whenever you want to append something to the
@@ -64,9 +345,11 @@ typedef struct CD9List {
      * @param self A pointer to the list.
      * @param data The data you want to append. It must be typecsted to void *.
      *
-     * @return void It doesn't return anything.
+     * @return int It returns `1` on success or `0` if malloc failed or the
+     *         list doesn't hold elements of that size, see
+     *         `cd9list_createListOfSize`.
      */
-    void (*append)(void *self, const void *data);
+    int (*append)(void *self, const void *data);
 
     /**
      * @brief Use this function when you want to append a copy of the data
@@ -85,9 +368,11 @@ typedef struct CD9List {
      *        because we need to know how large should be the block of memory
      *        allocated for the copy. 
      *
-     * @return void It doesn't return anything.
+     * @return int It returns `1` on success or `0` if malloc failed or the
+     *         list doesn't hold elements of that size, see
+     *         `cd9list_createListOfSize`.
      */
-    void (*appendCopy)(void *self, const void *data, size_t size);
+    int (*appendCopy)(void *self, const void *data, size_t size);
 
     /**
      * @brief Call this function whenever you want to add a new node at the 
@@ -96,9 +381,11 @@ typedef struct CD9List {
      * @param self A pointer to the current list.
      * @param data The data saved in the current node.
      *
-     * @return void It doesn't return anything.
+     * @return int It returns `1` on success or `0` if malloc failed or the
+     *         list doesn't hold elements of that size, see
+     *         `cd9list_createListOfSize`.
      */
-    void (*prepend)(void *self, const void *data);
+    int (*prepend)(void *self, const void *data);
 
     /**
      * @brief This function is similar to \ref appendCopy, the only difference
@@ -108,9 +395,11 @@ typedef struct CD9List {
      * @param data The data you want to prepend.
      * @param size The size of the data you want to prepend.
      *
-     * @return void It doesn't return anything.
+     * @return int It returns `1` on success or `0` if malloc failed or the
+     *         list doesn't hold elements of that size, see
+     *         `cd9list_createListOfSize`.
      */ 
-    void (*prependCopy)(void *self, const void *data, size_t size);
+    int (*prependCopy)(void *self, const void *data, size_t size);
     
     /**
      * @brief Call this function to get the data of the node stored at that 
@@ -155,9 +444,11 @@ typedef struct CD9List {
      * @param index The index where you want to insert the item.
      * @param data The data you want to insert.
      *
-     * @return void It doesn't return anything.
+     * @return int It returns `1` on success or `0` if malloc failed,
+     *         `index` is out of range or the list doesn't hold elements of
+     *         that size, see `cd9list_createListOfSize`.
      */ 
-    void (*insert)(void *self, size_t index, const void *data);
+    int (*insert)(void *self, size_t index, const void *data);
 
     /**
      * @brief Use this function to get the index of the first occurence of
@@ -224,12 +515,14 @@ typedef struct CD9List {
      * @param size The size of the data you want to insert, thus the function
      *        will know how much memory should allocate when creating the copy.
      *
-     * @return void It doesn't return anything.
+     * @return int It returns `1` on success or `0` if malloc failed,
+     *         `index` is out of range or the list doesn't hold elements of
+     *         that size, see `cd9list_createListOfSize`.
      */ 
-    void (*_insertCopy)(void       *self,
-                        size_t     index, 
-                        const void *value, 
-                        size_t     size);
+    int (*_insertCopy)(void       *self,
+                       size_t     index, 
+                       const void *value, 
+                       size_t     size);
 
     /**
      * @brief Use this function to reverse the current list.
@@ -248,7 +541,7 @@ typedef struct CD9List {
      *
      * @param self The current list.
      *
-     * @return CD9List * A pointer to the copy.       
+     * @return CD9List * A pointer to the copy or `NULL` if malloc failed.
      */ 
     struct CD9List *(*copy)(void *self);
 
@@ -267,9 +560,10 @@ typedef struct CD9List {
      *        The same rules of negative indexes apply as above. Note that if
      *        you want to have the last element in your slice `stop` should be
      *        equal to `0`. A `0` stop means to slice until the end(inclusiv).
-     * @param step The range between elements in the slice.
+     * @param step The range between elements in the slice. It can't be `0`.
      *
-     * @return CD9List * A pointer to the slice.
+     * @return CD9List * A pointer to the slice or `NULL` if malloc failed or
+     *         `step` is `0`.
      */ 
     struct CD9List *(*slice)(void *self, int start, int stop, size_t step);
 
@@ -293,7 +587,8 @@ typedef struct CD9List {
      * @param cmp The comparator function used to determine if an element
      *        should be filtered. 
      *
-     * @return CD9List * It returns the filtered list.
+     * @return CD9List * It returns the filtered list or `NULL` if malloc
+     *         failed.
      */
     struct CD9List *(*filter)(void            *self, 
                               const void      *data,
@@ -306,7 +601,7 @@ typedef struct CD9List {
      * @param self The current list.
      * @param data The value that will be eliminated from this list.
      *
-     * @return CD9List * The filtered list.  
+     * @return CD9List * The filtered list or `NULL` if malloc failed.
      */ 
     struct CD9List *(*filterByValue)(void *self, const void *data);
 
@@ -317,18 +612,46 @@ typedef struct CD9List {
      * @param self The current list.
      * @param set The values that will be eliminated from list.
      *
-     * @return CD9List * The filtered list.
+     * @return CD9List * The filtered list or `NULL` if malloc failed.
      */ 
     struct CD9List *(*filterBySet)(void *self, struct CD9List *set);
 } CD9List;
 
 
+/**
+ * @brief Hints the processor to load the node after `node` and its data in
+ *        the cache, so they are there when the loop gets to them. It is an
+ *        expression, so it can be used in the condition of a `for`.
+ */
+#if defined(__GNUC__)
+#define CD9PREFETCH_NODE(node) \
+    (((node)->next != NULL) ? \
+     (__builtin_prefetch((node)->next->next), \
+      __builtin_prefetch((node)->next->data)) : (void)0)
+#else
+#define CD9PREFETCH_NODE(node) ((void)0)
+#endif
+
+/**
+ * @brief The prefetching done by the loops of the library and by the
+ *        foreach macros. It is compiled in only when `CD9LIST_PREFETCH` is
+ *        defined, for example `make FEATURES=-DCD9LIST_PREFETCH`, since it
+ *        only pays off for lists whose nodes are scattered in memory.
+ */
+#ifdef CD9LIST_PREFETCH
+#define CD9PREFETCH_HINT(node) CD9PREFETCH_NODE(node)
+#else
+#define CD9PREFETCH_HINT(node) ((void)0)
+#endif
+
 /**
  * @brief Use this version of foreach to iterate over nodes in a list. All you
  *        will get is a node per iteration.
  */ 
 #define CD9FOREACH_2(list, node) for(CD9Node *node = list->nodes; \
-                                     node != NULL; node = node->next)
+                                     node != NULL && \
+                                     (CD9PREFETCH_HINT(node), 1); \
+                                     node = node->next)
 /**
  * @brief Use this version to iterate over the nodes in a list. You will get
  *        a node and it's index per iteration. Keep in mind that this macro
@@ -337,7 +660,8 @@ typedef struct CD9List {
  */ 
 #define CD9FOREACH_3(list, node, index) \
     for(size_t index = 0, stopF1 = 1; stopF1 != 0; stopF1 = 0 ) \
-        for(CD9Node *node = list->nodes; node != NULL; \
+        for(CD9Node *node = list->nodes; \
+            node != NULL && (CD9PREFETCH_HINT(node), 1); \
             node = node->next, index++)
 /**
  * @brief This version of foreach shouldn't be used by the library user 
@@ -356,7 +680,8 @@ typedef struct CD9List {
 #define CD9FOREACH2(list, value) \
     for(CD9Node *node = list->nodes, *stopF1 = list->nodes; stopF1 != NULL;\
         stopF1 = NULL) \
-        for(void *value = node->data; node != NULL; \
+        for(void *value = node->data; \
+            node != NULL && (CD9PREFETCH_HINT(node), 1); \
             value = ((node->next != NULL) ? \
                      node->next->data : NULL), \
             node = node->next)
@@ -370,7 +695,7 @@ typedef struct CD9List {
         stopF1 = NULL) \
         for(size_t index = 0, stopF2 = 1; stopF2 != 0; stopF2 = 0) \
             for(void *value = node->data; \
-                node != NULL; \
+                node != NULL && (CD9PREFETCH_HINT(node), 1); \
                 value = ((node->next != NULL) ? \
                          node->next->data : NULL), \
                 node = node->next, \
@@ -382,6 +707,42 @@ typedef struct CD9List {
  */
 #define CD9FOREACH(...) MACRO_DISPATCHER(CD9FOREACH, __VA_ARGS__)
 
+/**
+ * @brief Similar to \ref CD9FOREACH2, but it always prefetches the next node
+ *        and its data, even when `CD9LIST_PREFETCH` is not defined. Use it
+ *        for the loops over big lists whose nodes are scattered in memory.
+ */
+#define CD9FOREACH_PREFETCH2(list, value) \
+    for(CD9Node *node = list->nodes, *stopF1 = list->nodes; stopF1 != NULL;\
+        stopF1 = NULL) \
+        for(void *value = node->data; \
+            node != NULL && (CD9PREFETCH_NODE(node), 1); \
+            value = ((node->next != NULL) ? \
+                     node->next->data : NULL), \
+            node = node->next)
+
+/**
+ * @brief Similar to \ref CD9FOREACH3, but it always prefetches the next node
+ *        and its data, see \ref CD9FOREACH_PREFETCH2.
+ */
+#define CD9FOREACH_PREFETCH3(list, value, index) \
+    for(CD9Node *node = list->nodes, *stopF1 = list->nodes; stopF1 != NULL; \
+        stopF1 = NULL) \
+        for(size_t index = 0, stopF2 = 1; stopF2 != 0; stopF2 = 0) \
+            for(void *value = node->data; \
+                node != NULL && (CD9PREFETCH_NODE(node), 1); \
+                value = ((node->next != NULL) ? \
+                         node->next->data : NULL), \
+                node = node->next, \
+                index++)
+
+/**
+ * @brief The prefetching version of \ref CD9FOREACH, it takes the same
+ *        arguments.
+ */
+#define CD9FOREACH_PREFETCH(...) \
+    MACRO_DISPATCHER(CD9FOREACH_PREFETCH, __VA_ARGS__)
+
 /**
  * @brief This is the callback that will be passed when calling 
  *        `cd9list_foreach`. This callback will be called on every item on the
@@ -417,6 +778,279 @@ CD9Node *cd9list_createNode(const void *data, size_t size);
  */
 CD9List *cd9list_createList();
 
+/**
+ * @brief Use this function to create a list that allocates its memory with
+ *        `allocator` instead of `malloc` and `free`. The data returned by
+ *        `pop` and `popleft` is still allocated with `malloc`, because it is
+ *        yours to free.
+ *
+ * @param allocator The allocator, it is copied in the list. If it is `NULL`
+ *        the list will use `malloc` and `free`.
+ *
+ * @return CD9List * Returns a newly allocated list.
+ */
+CD9List *cd9list_createListWithAllocator(const CD9Allocator *allocator);
+
+/**
+ * @brief Use this function to create a list for a few small elements. The
+ *        first \ref CD9LIST_INLINE_NODES elements, references or copies of
+ *        up to \ref CD9LIST_INLINE_SIZE bytes, are kept inside the list
+ *        object, so they don't need any allocation. The other elements get
+ *        nodes like in any list. The list works like the others, only the
+ *        place of the nodes changes. The lists created from a small list,
+ *        for example by `copy`, are small as well.
+ *
+ * @return CD9List * The list or `NULL` if malloc failed.
+ */
+CD9List *cd9list_createSmallList();
+
+/**
+ * @brief Similar to `cd9list_createSmallList`, but the list and its nodes
+ *        are allocated with `allocator`, see
+ *        `cd9list_createListWithAllocator`.
+ *
+ * @param allocator The allocator or `NULL` for `malloc` and `free`.
+ *
+ * @return CD9List * The list or `NULL` if the allocation failed.
+ */
+CD9List *cd9list_createSmallListWithAllocator(const CD9Allocator *allocator);
+
+/**
+ * @brief Use this function to create a list for elements of a known size,
+ *        for example an array of records. A copy of `elementSize` bytes is
+ *        stored right after its node, in the same allocation, so it costs a
+ *        single allocation and no pointer has to be followed to reach it.
+ *        The nodes don't store their size either, see \ref CD9PackedNode.
+ *
+ *        The list only holds copies of `elementSize` bytes, the functions
+ *        that add references or copies of other sizes return `0`.
+ *
+ * @param elementSize The size of the elements.
+ *
+ * @return CD9List * The list or `NULL` if malloc failed.
+ */
+CD9List *cd9list_createListOfSize(size_t elementSize);
+
+/**
+ * @brief Similar to `cd9list_createListOfSize`, but the list uses
+ *        `allocator`, see `cd9list_createListWithAllocator`.
+ *
+ * @param elementSize The size of the elements.
+ * @param allocator The allocator or `NULL` for the default one.
+ *
+ * @return CD9List * The list or `NULL` if the allocation failed.
+ */
+CD9List *cd9list_createListOfSizeWithAllocator(size_t             elementSize,
+                                               const CD9Allocator *allocator);
+
+/**
+ * @brief Use this function to create a list whose copies are reference
+ *        counted. The lists derived from it by `copy`, `concat`, `slice`,
+ *        `filter`, `filterByValue` and `filterBySet` point to the same
+ *        copies instead of copying the bytes again, a copy is freed when the
+ *        last node that uses it is deleted. The elements must not be changed
+ *        in place, since every derived list would see the change.
+ *
+ * @return CD9List * The list or `NULL` if malloc failed.
+ */
+CD9List *cd9list_createRefCountedList();
+
+/**
+ * @brief Similar to `cd9list_createRefCountedList`, but the list uses
+ *        `allocator`, see `cd9list_createListWithAllocator`. The copies are
+ *        only shared with the lists that use the same allocator.
+ *
+ * @param allocator The allocator or `NULL` for the default one.
+ *
+ * @return CD9List * The list or `NULL` if the allocation failed.
+ */
+CD9List *cd9list_createRefCountedListWithAllocator(
+    const CD9Allocator *allocator);
+
+/**
+ * @brief Use this function to create a list whose nodes, and the copies 
+ *        made by the *Copy functions, are carved sequentially from `arena`.
+ *        Removing an element from such a list doesn't give its memory back,
+ *        all of it is freed at once when the arena is released. The list
+ *        takes its own reference to the arena, so you can release yours as
+ *        soon as you don't need it anymore.
+ *
+ * @param arena The arena, see `cd9arena_create`.
+ *
+ * @return CD9List * Returns a newly allocated list.
+ */
+CD9List *cd9list_createListOnArena(CD9Arena *arena);
+
+/**
+ * @brief Use this function to create a list that owns an arena of its own.
+ *        It is similar to `cd9list_createListOnArena`, but `cd9list_deleteList`
+ *        will free all the nodes with a single call, instead of walking the
+ *        list. It is a good fit for lists that are built, used and thrown
+ *        away in one go.
+ *
+ * @param blockSize The size of the blocks requested by the arena, `0` for
+ *        the default.
+ *
+ * @return CD9List * Returns a newly allocated list.
+ */
+CD9List *cd9list_createArenaList(size_t blockSize);
+
+/**
+ * @brief Use this function to move all the nodes of a list and their copies
+ *        in a single block of memory, laid out in the order of the list. The
+ *        old nodes are freed. It is a good fit for lists that are built once
+ *        and walked many times, since the walks don't jump around the memory
+ *        anymore. The list owns an arena from now on, see
+ *        `cd9list_createArenaList`. The nodes that store addresses keep the
+ *        same address, but the pointers you got to the copies, for example
+ *        from `get`, are not valid anymore. A reference counted list keeps
+ *        its mode, the lists derived from it afterwards share the copies in
+ *        the arena. Don't use it on the list of a \ref CD9SortedList, its
+ *        towers point to the old nodes.
+ *
+ * @param list The list.
+ *
+ * @return int It returns `1` on success and `0` if the memory couldn't be
+ *         allocated, the list is not changed in that case.
+ */
+int cd9list_compact(CD9List *list);
+
+/**
+ * @brief Use this function to create an empty list that allocates its nodes
+ *        the same way `list` does. It is used by the functions that return
+ *        new lists, such as `copy` or `filter`. This function is intended to
+ *        be used internally.
+ *
+ * @param list The list whose settings are inherited.
+ *
+ * @return CD9List * Returns a newly allocated list.
+ */
+CD9List *cd9list_createListLike(const CD9List *list);
+
+/**
+ * @brief Similar to `cd9list_createNode`, but the node is allocated the way
+ *        `list` allocates its nodes. This function is intended to be used
+ *        internally.
+ *
+ * @param list The list the node will be linked in.
+ * @param data The value of the new node.
+ * @param size The number of bytes that should be copied or `SIZE_ZERO`.
+ *
+ * @return CD9Node * A pointer to the node that was created or `NULL` if
+ *         malloc failed or the list doesn't hold elements of that size, see
+ *         `cd9list_createListOfSize`.
+ */
+CD9Node *cd9list_createListNode(CD9List *list, const void *data, size_t size);
+
+/**
+ * @brief Use this function to know the size of the copy stored by a node of
+ *        `list`, or `SIZE_ZERO` if it stores a reference. Use it instead of
+ *        \ref CD9Node::size, which the nodes of the lists created with
+ *        `cd9list_createListOfSize` don't have.
+ *
+ * @param list The list the node belongs to.
+ * @param node The node.
+ *
+ * @return size_t The size of the copy.
+ */
+size_t cd9list_nodeSize(const CD9List *list, const CD9Node *node);
+
+/**
+ * @brief Similar to `cd9list_deleteNode`, but it frees a node created by
+ *        `cd9list_createListNode`. This function is intended to be used
+ *        internally.
+ *
+ * @param list The list the node belonged to.
+ * @param node The node you want to delete.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9list_deleteListNode(CD9List *list, CD9Node *node);
+
+/**
+ * @brief Use this function to turn the copy-on-write mode of a list on or
+ *        off. In this mode `copy` takes constant time, since the copy shares
+ *        the nodes and the copies of the data with the list. `slice` shares
+ *        the nodes when it takes the end of the list with a step of `1`, and
+ *        `concat` shares the nodes of the second list when that list is in
+ *        copy-on-write mode as well. The shared nodes are copied the first
+ *        time one of the lists changes them, so the lists keep behaving like
+ *        independent lists. Adding or removing the first element doesn't
+ *        copy anything. The lists created from a list, for example by
+ *        `copy`, inherit its mode.
+ *
+ *        The data returned by `get` may be shared, call `cd9list_unshare`
+ *        before you write to it.
+ *
+ * @param list The list.
+ * @param enabled `true` to turn the mode on.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9list_setCopyOnWrite(CD9List *list, bool enabled);
+
+/**
+ * @brief Use this function to give a list its own copy of the nodes it
+ *        shares with other lists. It is called by every function that
+ *        changes the shared nodes.
+ *
+ * @param list The list.
+ *
+ * @return int It returns `1` on success and `0` if the memory couldn't be
+ *         allocated, the list still shares its nodes in that case.
+ */
+int cd9list_unshare(CD9List *list);
+
+/**
+ * @brief Use this function to store the hash of every copy of a list with
+ *        the copy. `findByValue`, `filterByValue`, `filterBySet` and
+ *        `cd9list_equals` then compare the hashes first, and compare the
+ *        bytes only when the hashes are equal, which is much faster for the
+ *        copies that don't match. The hash is computed when a copy is added
+ *        to the list, and every copy gets one when the mode is turned on.
+ *        The lists created from a list inherit its mode.
+ *
+ *        The hash is kept in a \ref CD9PayloadHeader in front of the copy,
+ *        so the nodes don't grow. The first time the mode is turned on the
+ *        copies are moved after a header, the pointers you got to them, for
+ *        example from `get`, are not valid anymore. The copies kept inside a
+ *        small list don't have a hash, see `cd9list_createSmallList`.
+ *
+ *        If you change a copy in place, call this function again so its
+ *        hash is computed again.
+ *
+ * @param list The list.
+ * @param enabled `true` to turn the mode on. The copies keep their hashes
+ *        when it is turned off, the new copies just don't get one.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed, the list is
+ *         not changed in that case.
+ */
+int cd9list_setHashing(CD9List *list, bool enabled);
+
+/**
+ * @brief Use this function to know if 2 lists hold the same elements in the
+ *        same order. The copies are equal if they have the same bytes and
+ *        the references if they are the same address.
+ *
+ * @param list1 The first list.
+ * @param list2 The second list.
+ *
+ * @return bool It returns `true` if the lists are equal.
+ */
+bool cd9list_equals(const CD9List *list1, const CD9List *list2);
+
+/**
+ * @brief Use this function to hash an element the way the lists do, see
+ *        `cd9list_setHashing` and `cd9list_unique`.
+ *
+ * @param data The data of the element.
+ * @param size The size of the element, `0` if the list stores its address.
+ *
+ * @return size_t The hash of the element.
+ */
+size_t cd9list_defaultHash(const void *data, size_t size);
+
 /**
  * @brief Use this function to free the memeory allocated to a list. It will
  *        delete all its elements.
@@ -430,11 +1064,13 @@ void cd9list_deleteList(CD9List *list);
 /**
  * @brief Use this function to free the memeory allocated to a node.
  *
+ * @param list The list the node belonged to or `NULL` if it was created by
+ *        `cd9list_createNode`.
  * @param node The node you want to delete.
  *
  * @return void It doesn't return anything.
  */
-void cd9list_deleteNode(CD9Node *node);
+void cd9list_deleteNode(CD9List *list, CD9Node *node);
 
 
 /**
@@ -465,11 +1101,16 @@ CD9Node *cd9list_getNode(const CD9List *list, size_t index);
  *        node data before deleting it. And that is the purpose of this 
  *        function.
  *
+ *        The nodes of the lists created with `cd9list_createListOfSize`
+ *        don't store their size, so the list is needed to know it.
+ *
+ * @brief list The list the node belongs to or `NULL` if it was created by
+ *        `cd9list_createNode`.
  * @brief node The node whose data you want to copy.
  *
- * @brief CD9Node * A of the `node`'s data.
+ * @brief CD9Node * A of the `node`'s data or `NULL` if malloc failed.
  */ 
-void *cd9list_copyNodeData(const CD9Node *node);
+void *cd9list_copyNodeData(const CD9List *list, const CD9Node *node);
 
 /**
  * @brief Use this function to concatenate 2 lists. It returns a pointer to
@@ -479,9 +1120,298 @@ void *cd9list_copyNodeData(const CD9Node *node);
  * @param list1 The first list.
  * @param list2 The second list.
  *
- * @return CD9List * Pointer to the concatenated version of the 2 lists.
+ * @return CD9List * Pointer to the concatenated version of the 2 lists or
+ *         `NULL` if malloc failed. The result is created like `list1`, so
+ *         it is `NULL` as well if `list1` holds elements of a given size,
+ *         see `cd9list_createListOfSize`, and `list2` has other elements.
  */ 
 CD9List *cd9list_concat(CD9List *list1, CD9List *list2);
 
+/**
+ * @brief Use this function to merge 2 sorted lists in linear time. The
+ *        nodes of `list2` are linked into `list1` without copying them,
+ *        unless `list2` uses another arena or allocator, in which case its
+ *        elements are copied. The merge is stable, the elements of `list1`
+ *        come first when they are equal.
+ *
+ * @param list1 The first list, it receives the result.
+ * @param list2 The second list, it is left empty but it still has to be
+ *        deleted. It must not be `list1`.
+ * @param cmp The comparison function the lists are sorted with, see
+ *        \ref CD9List::sort.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed, the lists
+ *         are not changed in that case.
+ */
+int cd9list_mergeSorted(CD9List            *list1,
+                        CD9List            *list2,
+                        CD9CompareCallback cmp);
+
+/**
+ * @brief Similar to `cd9list_mergeSorted`, but it merges `k` sorted lists
+ *        at once with a heap, in `O(N log k)` time.
+ *
+ * @param lists The lists. The first one receives the result, the others are
+ *        left empty. A list must not appear twice.
+ * @param k The number of lists.
+ * @param cmp The comparison function the lists are sorted with.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed, the lists
+ *         are not changed in that case.
+ */
+int cd9list_mergeK(CD9List **lists, size_t k, CD9CompareCallback cmp);
+
+/**
+ * @brief Use this function to get the `k` smallest elements of a list in
+ *        order, without sorting the whole list. It takes `O(N log k)` time.
+ *        The equal elements keep their order.
+ *
+ * @param list The list, it is not changed.
+ * @param k The number of elements, the whole list is sorted if it is bigger
+ *        than the length of the list.
+ * @param cmp The comparison function, see \ref CD9List::sort.
+ *
+ * @return CD9List * A new list with copies of the elements, the references
+ *         stay references. It is `NULL` if malloc failed.
+ */
+CD9List *cd9list_topK(const CD9List *list, size_t k, CD9CompareCallback cmp);
+
+/**
+ * @brief Use this function to get the element that would be at the index
+ *        `n` if the list was sorted, in linear time on average. The list is
+ *        not changed.
+ *
+ * @param list The list.
+ * @param n The index in the sorted list.
+ * @param cmp The comparison function, see \ref CD9List::sort.
+ *
+ * @return void * The data of the element, like \ref CD9List::get. It is
+ *         `NULL` if `n` is out of range or malloc failed.
+ */
+void *cd9list_nthElement(const CD9List      *list,
+                         size_t             n,
+                         CD9CompareCallback cmp);
+
+/**
+ * @brief Use this function to append a buffer allocated with `malloc`
+ *        without copying it, the list takes it over and frees it like its
+ *        copies. The lists with an arena or another allocator than `malloc`
+ *        can't free it, so they store a copy and free the buffer right away.
+ *
+ * @param list The list.
+ * @param data The buffer, it belongs to the list once the call succeeds.
+ * @param size The size of the buffer, it must not be `0`.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed or `size`
+ *         is `0`, the buffer still belongs to you in that case.
+ */
+int cd9list_appendOwned(CD9List *list, void *data, size_t size);
+
+/**
+ * @brief Similar to `cd9list_appendOwned`, but the buffer becomes the first
+ *        element of the list.
+ *
+ * @param list The list.
+ * @param data The buffer.
+ * @param size The size of the buffer.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed or `size`
+ *         is `0`.
+ */
+int cd9list_prependOwned(CD9List *list, void *data, size_t size);
+
+/**
+ * @brief Similar to `pop`, but the copy stored by the list is handed to
+ *        you as it is, instead of a new copy, when the list allocates it
+ *        with `malloc`. Otherwise you get a copy, so you can always free the
+ *        result with `free`.
+ *
+ * @param list The list.
+ * @param size If it is not `NULL`, it is filled with the size of the
+ *        element, `0` for a reference.
+ *
+ * @return void * The element, it belongs to you if it is a copy. It is
+ *         `NULL` if the list is empty or malloc failed.
+ */
+void *cd9list_popOwned(CD9List *list, size_t *size);
+
+/**
+ * @brief Similar to `cd9list_popOwned`, but it takes the first element, in
+ *        constant time.
+ *
+ * @param list The list.
+ * @param size If it is not `NULL`, it is filled with the size of the
+ *        element.
+ *
+ * @return void * The element or `NULL` if the list is empty.
+ */
+void *cd9list_popleftOwned(CD9List *list, size_t *size);
+
+/**
+ * @brief Use this function to move the elements of a list, starting with
+ *        the one at `index`, to a new list. The nodes are moved, nothing is
+ *        copied, so a queue can be cut into chunks without copying its
+ *        elements. Only the nodes up to `index` are visited. In
+ *        copy-on-write mode the shared nodes are copied only if `index`
+ *        falls among them.
+ *
+ * @param list The list, it keeps the first `index` elements.
+ * @param index The index of the first element that is moved. If it is not
+ *        smaller than the length of the list the new list is empty.
+ *
+ * @return CD9List * The new list, created like `list`, or `NULL` if malloc
+ *         failed. The list is not changed in that case.
+ */
+CD9List *cd9list_splitAt(CD9List *list, size_t index);
+
+/**
+ * @brief Use this function to rotate a list to the left, the element at
+ *        `count` becomes the first one and the first `count` elements go to
+ *        the end. The nodes are relinked, nothing is copied. Use
+ *        `length - count` to rotate to the right.
+ *
+ * @param list The list.
+ * @param count The number of elements moved to the end, it may be bigger
+ *        than the length of the list.
+ *
+ * @return int It returns `1` on success or `0` if malloc failed, see
+ *         `cd9list_unshare`.
+ */
+int cd9list_rotate(CD9List *list, size_t count);
+
+/**
+ * @brief Use this function to remove many elements at once, in a single
+ *        walk of the list, instead of calling `remove` for every one of
+ *        them.
+ *
+ * @param list The list.
+ * @param indices The indices of the elements, in any order. The indices
+ *        that appear more than once are removed once, the ones that are out
+ *        of range are ignored.
+ * @param count The number of indices.
+ * @param removed If it is not `NULL`, it is filled with the data of the
+ *        removed elements in the order of the list, like `pop` returns it:
+ *        the copies belong to you and must be freed with `free`. It must
+ *        have room for `count` elements.
+ *
+ * @return size_t The number of elements removed. It is `0` if malloc
+ *         failed, the list is not changed in that case.
+ */
+size_t cd9list_removeIndices(CD9List      *list,
+                             const size_t *indices,
+                             size_t       count,
+                             void         **removed);
+
+/**
+ * @brief Similar to `cd9list_removeIndices`, but the elements are given by
+ *        their nodes, for example the ones returned by `cd9list_getNode`.
+ *
+ * @param list The list.
+ * @param nodes The nodes, in any order. The nodes that are not in the list
+ *        and the `NULL` ones are ignored.
+ * @param count The number of nodes.
+ * @param removed The data of the removed elements or `NULL`, see
+ *        `cd9list_removeIndices`.
+ *
+ * @return size_t The number of elements removed. It is `0` if malloc
+ *         failed, the list is not changed in that case.
+ */
+size_t cd9list_removeNodes(CD9List        *list,
+                           CD9Node *const *nodes,
+                           size_t         count,
+                           void           **removed);
+
+/**
+ * @brief Use this function to remove the duplicates of a list, the first
+ *        occurrence of every element is kept. It takes linear time, since
+ *        the elements are looked up in a hash table.
+ *
+ * @param list The list.
+ * @param hash The hash function or `NULL`. By default the bytes of the
+ *        copies are hashed, and the addresses of the nodes that store
+ *        addresses.
+ * @param equal The function that tells if 2 elements are equal or `NULL`.
+ *        By default the copies are equal if they have the same bytes, and
+ *        the addresses if they are the same address.
+ *
+ * @return size_t The number of elements removed. It is `0` if malloc failed,
+ *         the list is not changed in that case.
+ */
+size_t cd9list_unique(CD9List          *list,
+                      CD9HashCallback  hash,
+                      CD9EqualCallback equal);
+
+/**
+ * @brief Use this function to count the different elements of a list, see
+ *        `cd9list_unique`.
+ *
+ * @param list The list.
+ * @param hash The hash function or `NULL` for the default one.
+ * @param equal The function that compares the elements or `NULL` for the
+ *        default one.
+ *
+ * @return size_t The number of different elements. It is `0` for a list
+ *         that is not empty only if malloc failed.
+ */
+size_t cd9list_countDistinct(const CD9List    *list,
+                             CD9HashCallback  hash,
+                             CD9EqualCallback equal);
+
+/**
+ * @brief Similar to \ref CD9List::find, but the elements are passed to `cmp`
+ *        in batches, see \ref CD9BatchFindCallback. The walk of a batch
+ *        can't overlap with the comparisons, so a trivial comparison is
+ *        faster with \ref CD9List::find.
+ *
+ * @param list The list.
+ * @param key The data you want to find.
+ * @param cmp The comparator.
+ *
+ * @return int The index of the first match or `-1` if there is no match.
+ */
+int cd9list_findBatched(const CD9List        *list,
+                        const void           *key,
+                        CD9BatchFindCallback cmp);
+
+/**
+ * @brief Similar to \ref CD9List::filter, but the elements are passed to
+ *        `cmp` in batches, see \ref CD9BatchFindCallback. The elements that
+ *        match `key` are dropped.
+ *
+ * @param list The list.
+ * @param key This data will be passed to `cmp` at every call.
+ * @param cmp The comparator.
+ *
+ * @return CD9List * The filtered list or `NULL` if malloc failed.
+ */
+CD9List *cd9list_filterBatched(const CD9List        *list,
+                               const void           *key,
+                               CD9BatchFindCallback cmp);
+
+#ifdef CD9LIST_STATS
+/**
+ * @brief Use this function to get the counters of a list.
+ *
+ * @param list The list.
+ *
+ * @return const CD9ListStats * The counters of the list.
+ */
+const CD9ListStats *cd9list_getStats(const CD9List *list);
+
+/**
+ * @brief Use this function to get the counters of all the lists together,
+ *        including the ones that were already deleted.
+ *
+ * @return const CD9ListStats * The global counters.
+ */
+const CD9ListStats *cd9list_getGlobalStats();
+
+/**
+ * @brief Use this function to set all the global counters to `0`.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9list_resetGlobalStats();
+#endif
 
 #endif // CD9LIST_H__
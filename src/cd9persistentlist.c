@@ -0,0 +1,391 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cd9list.h"
+#include "callbacks.h"
+#include "cd9persistentlist.h"
+
+/**
+ * @brief Helper function that returns the node stored at `offset`.
+ */
+CD9PersistentNode *cd9persistentlist_nodeAt(const CD9PersistentList *plist,
+                                            uint64_t                offset)
+{
+    if(offset == 0) {
+        return NULL;
+    }
+
+    return (CD9PersistentNode *)((unsigned char *)plist->header + offset);
+}
+
+/**
+ * @brief Helper function that returns the node stored at `offset` if the
+ *        node and its data lie in the used part of the file. The offsets come
+ *        from the file, so they are checked before a node is read.
+ *
+ * @return CD9PersistentNode * The node or `NULL` if `offset` is `0` or it
+ *         doesn't point to a node.
+ */
+CD9PersistentNode *cd9persistentlist_validNode(const CD9PersistentList *plist,
+                                               uint64_t                offset)
+{
+    uint64_t used = plist->header->used;
+
+    if(offset < sizeof(CD9PersistentHeader) || offset % 8 != 0 ||
+       offset >= used || used - offset < sizeof(CD9PersistentNode)) {
+        return NULL;
+    }
+
+    CD9PersistentNode *node = cd9persistentlist_nodeAt(plist, offset);
+
+    if(node->size > used - offset - sizeof(CD9PersistentNode)) {
+        return NULL;
+    }
+
+    return node;
+}
+
+/**
+ * @brief Helper function that tells if the header of an existing file can be
+ *        trusted: the file holds a list of this version and the head and the
+ *        tail point to nodes.
+ */
+bool cd9persistentlist_checkHeader(const CD9PersistentList *plist)
+{
+    const CD9PersistentHeader *header = plist->header;
+
+    if(memcmp(header->magic, CD9PERSISTENTLIST_MAGIC, 4) != 0 ||
+       header->version != CD9PERSISTENTLIST_VERSION ||
+       header->used < sizeof(CD9PersistentHeader) ||
+       header->used > plist->capacity) {
+        return false;
+    }
+
+    // The head, the tail and the length are 0 only when the list is empty.
+    if(header->head == 0 || header->tail == 0 || header->length == 0) {
+        return header->head == 0 && header->tail == 0 && header->length == 0;
+    }
+
+    return cd9persistentlist_validNode(plist, header->head) != NULL &&
+           cd9persistentlist_validNode(plist, header->tail) != NULL;
+}
+
+/**
+ * @brief Helper function that returns the number of bytes a node with
+ *        `size` bytes of data takes in the file. The nodes are aligned to 8
+ *        bytes.
+ */
+uint64_t cd9persistentlist_nodeSize(uint64_t size)
+{
+    return (sizeof(CD9PersistentNode) + size + 7) & ~(uint64_t)7;
+}
+
+/**
+ * @brief Helper function that changes the size of the file and maps it
+ *        again.
+ *
+ * @param plist The list.
+ * @param capacity The new size of the file.
+ *
+ * @return bool It returns `false` if the file couldn't be resized or mapped,
+ *         the old mapping is kept in that case.
+ */
+bool cd9persistentlist_remap(CD9PersistentList *plist, size_t capacity)
+{
+    if(ftruncate(plist->fd, capacity) != 0) {
+        return false;
+    }
+
+    void *mapping = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         plist->fd, 0);
+    if(mapping == MAP_FAILED) {
+        return false;
+    }
+
+    munmap(plist->header, plist->capacity);
+
+    plist->header   = mapping;
+    plist->capacity = capacity;
+
+    return true;
+}
+
+CD9PersistentNode *cd9persistentlist_first(const CD9PersistentList *plist)
+{
+    return cd9persistentlist_validNode(plist, plist->header->head);
+}
+
+CD9PersistentNode *cd9persistentlist_next(const CD9PersistentList *plist,
+                                          const CD9PersistentNode *node)
+{
+    // A corrupt link ends the list instead of pointing outside the file.
+    return cd9persistentlist_validNode(plist, node->next);
+}
+
+int cd9persistentlist_append(void *self, const void *data, size_t size)
+{
+    CD9PersistentList *plist = (CD9PersistentList *)self;
+    uint64_t nodeSize        = cd9persistentlist_nodeSize(size);
+
+    if(plist->capacity - plist->header->used < nodeSize) {
+        size_t capacity = plist->capacity * 2;
+
+        while(capacity - plist->header->used < nodeSize) {
+            capacity *= 2;
+        }
+
+        if(!cd9persistentlist_remap(plist, capacity)) {
+            return 0;
+        }
+    }
+
+    CD9PersistentHeader *header = plist->header;
+    uint64_t offset             = header->used;
+    CD9PersistentNode *node     = cd9persistentlist_nodeAt(plist, offset);
+
+    node->next = 0;
+    node->size = size;
+    memcpy(node->data, data, size);
+
+    // The nodes are only added at the end, so we can keep the tail and
+    // avoid walking the list.
+    if(header->tail == 0) {
+        header->head = offset;
+    }
+    else {
+        cd9persistentlist_nodeAt(plist, header->tail)->next = offset;
+    }
+
+    header->tail = offset;
+    header->used = offset + nodeSize;
+    header->length++;
+
+    return 1;
+}
+
+void *cd9persistentlist_get(void *self, size_t index)
+{
+    CD9PersistentList *plist = (CD9PersistentList *)self;
+    size_t i                 = 0;
+
+    CD9PFOREACH(plist, node) {
+        if(i++ == index) {
+            return node->data;
+        }
+    }
+
+    return NULL;
+}
+
+int cd9persistentlist_find(void *self, const void *data, CD9FindCallback cmp)
+{
+    CD9PersistentList *plist = (CD9PersistentList *)self;
+    int index                = 0;
+
+    CD9PFOREACH(plist, node) {
+        if(cmp(node->data, data, node->size)) {
+            return index;
+        }
+        index++;
+    }
+
+    return -1;
+}
+
+int cd9persistentlist_findByValue(void *self, const void *data)
+{
+    CD9PersistentList *plist = (CD9PersistentList *)self;
+
+    return plist->find(plist, data, callbacks_findByValueCmp);
+}
+
+int cd9persistentlist_remove(void *self, size_t index)
+{
+    CD9PersistentList *plist    = (CD9PersistentList *)self;
+    CD9PersistentHeader *header = plist->header;
+
+    if(index >= header->length) {
+        return 0; // Not a valid index.
+    }
+
+    CD9PersistentNode *prev = NULL;
+    uint64_t offset         = header->head;
+
+    for(size_t i = 0; i < index; i++) {
+        prev = cd9persistentlist_validNode(plist, offset);
+        if(prev == NULL) {
+            return 0; // The list is shorter than its length.
+        }
+
+        offset = prev->next;
+    }
+
+    CD9PersistentNode *node = cd9persistentlist_validNode(plist, offset);
+    if(node == NULL) {
+        return 0;
+    }
+
+    if(prev == NULL) {
+        header->head = node->next;
+    }
+    else {
+        prev->next = node->next;
+    }
+
+    if(header->tail == offset) {
+        header->tail = (prev == NULL) ? 0 :
+                       (uint64_t)((unsigned char *)prev -
+                                  (unsigned char *)header);
+    }
+
+    header->length--;
+
+    return 1;
+}
+
+int cd9persistentlist_sync(void *self)
+{
+    CD9PersistentList *plist = (CD9PersistentList *)self;
+
+    return msync(plist->header, plist->capacity, MS_SYNC) == 0;
+}
+
+int cd9persistentlist_compact(void *self)
+{
+    CD9PersistentList *plist    = (CD9PersistentList *)self;
+    CD9PersistentHeader *header = plist->header;
+    uint64_t write              = sizeof(CD9PersistentHeader);
+    uint64_t offset             = header->head;
+    uint64_t prev               = 0;
+    uint64_t length             = 0;
+    CD9PersistentNode *node;
+
+    // The nodes are laid out in the order of the list, so a node is never
+    // moved over a node that wasn't moved yet. A corrupt link ends the list,
+    // and so does a link that goes back in the file, it would break that
+    // order or make a cycle.
+    while(length < header->length &&
+          (node = cd9persistentlist_validNode(plist, offset)) != NULL) {
+        uint64_t next           = node->next;
+        uint64_t nodeSize       = cd9persistentlist_nodeSize(node->size);
+
+        if(write != offset) {
+            memmove(cd9persistentlist_nodeAt(plist, write), node, nodeSize);
+        }
+
+        if(prev == 0) {
+            header->head = write;
+        }
+        else {
+            cd9persistentlist_nodeAt(plist, prev)->next = write;
+        }
+
+        prev   = write;
+        write += nodeSize;
+        offset = (next > offset) ? next : 0;
+        length++;
+    }
+
+    if(prev == 0) {
+        header->head = 0;
+    }
+    else {
+        // The link that ended the list may be a corrupt one.
+        cd9persistentlist_nodeAt(plist, prev)->next = 0;
+    }
+
+    header->tail   = prev;
+    header->used   = write;
+    header->length = length;
+
+    // Keep the file at least as big as a new one, so the next appends don't
+    // have to grow it right away.
+    size_t capacity = (write < CD9PERSISTENTLIST_INITIAL_SIZE) ?
+                      CD9PERSISTENTLIST_INITIAL_SIZE : write;
+
+    if(capacity == plist->capacity) {
+        return 1;
+    }
+
+    return cd9persistentlist_remap(plist, capacity);
+}
+
+CD9PersistentList *cd9persistentlist_open(const char *path)
+{
+    CD9PersistentList *plist = malloc(sizeof(CD9PersistentList));
+    if(plist == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    plist->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if(plist->fd < 0) {
+        free(plist);
+        return NULL;
+    }
+
+    struct stat info;
+
+    if(fstat(plist->fd, &info) != 0) {
+        close(plist->fd);
+        free(plist);
+        return NULL;
+    }
+
+    bool isNew      = (info.st_size == 0);
+    plist->capacity = isNew ? CD9PERSISTENTLIST_INITIAL_SIZE : info.st_size;
+
+    if(plist->capacity < sizeof(CD9PersistentHeader) ||
+       (isNew && ftruncate(plist->fd, plist->capacity) != 0)) {
+        close(plist->fd);
+        free(plist);
+        return NULL;
+    }
+
+    plist->header = mmap(NULL, plist->capacity, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, plist->fd, 0);
+    if(plist->header == MAP_FAILED) {
+        close(plist->fd);
+        free(plist);
+        return NULL;
+    }
+
+    CD9PersistentHeader *header = plist->header;
+
+    if(isNew) {
+        memcpy(header->magic, CD9PERSISTENTLIST_MAGIC, 4);
+        header->version = CD9PERSISTENTLIST_VERSION;
+        header->length  = 0;
+        header->head    = 0;
+        header->tail    = 0;
+        header->used    = sizeof(CD9PersistentHeader);
+    }
+    else if(!cd9persistentlist_checkHeader(plist)) {
+        cd9persistentlist_close(plist);
+        return NULL;
+    }
+
+    // Now bind the functions.
+    plist->append      = cd9persistentlist_append;
+    plist->get         = cd9persistentlist_get;
+    plist->find        = cd9persistentlist_find;
+    plist->findByValue = cd9persistentlist_findByValue;
+    plist->remove      = cd9persistentlist_remove;
+    plist->sync        = cd9persistentlist_sync;
+    plist->compact     = cd9persistentlist_compact;
+
+    return plist;
+}
+
+void cd9persistentlist_close(CD9PersistentList *plist)
+{
+    munmap(plist->header, plist->capacity);
+    close(plist->fd);
+    free(plist);
+}
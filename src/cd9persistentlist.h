@@ -0,0 +1,221 @@
+#ifndef CD9PERSISTENTLIST_H__
+#define CD9PERSISTENTLIST_H__
+
+#include <stdint.h>
+#include "cd9list.h"
+
+/**
+ * @brief The first bytes of every file that holds a persistent list.
+ */
+#define CD9PERSISTENTLIST_MAGIC "CD9P"
+
+/**
+ * @brief The version of the file format written by this library.
+ */
+#define CD9PERSISTENTLIST_VERSION 1
+
+/**
+ * @brief The size of a new file, the file grows by doubling its size.
+ */
+#define CD9PERSISTENTLIST_INITIAL_SIZE (64 * 1024)
+
+/**
+ * @brief The header stored at the beginning of the file. Every position in
+ *        the file is an offset from the beginning of the file, an offset of
+ *        `0` plays the role of `NULL`. The numbers are stored in the byte
+ *        order of the machine, so the files can't be moved between machines
+ *        with a different one.
+ *
+ * @var CD9PersistentHeader::magic See \ref CD9PERSISTENTLIST_MAGIC.
+ * @var CD9PersistentHeader::version See \ref CD9PERSISTENTLIST_VERSION.
+ * @var CD9PersistentHeader::length The number of elements in the list.
+ * @var CD9PersistentHeader::head The offset of the first node.
+ * @var CD9PersistentHeader::tail The offset of the last node.
+ * @var CD9PersistentHeader::used The offset where the next node will be
+ *      written, everything after it is free.
+ */
+typedef struct CD9PersistentHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t length;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t used;
+} CD9PersistentHeader;
+
+/**
+ * @brief A node of a persistent list. Unlike \ref CD9Node, the data is
+ *        stored right after the node and the next node is referred to by its
+ *        offset.
+ *
+ * @var CD9PersistentNode::next The offset of the next node or `0`.
+ * @var CD9PersistentNode::size The number of bytes of `data`.
+ * @var CD9PersistentNode::data The data of the element.
+ */
+typedef struct CD9PersistentNode {
+    uint64_t next;
+    uint64_t size;
+    unsigned char data[];
+} CD9PersistentNode;
+
+/**
+ * @brief A list that lives in a memory mapped file. Opening a list doesn't
+ *        read it, the pages of the file are loaded by the system when they
+ *        are first touched. The list always stores copies of the data. The
+ *        nodes are only appended at the end of the file, so they are laid
+ *        out in the order of the list.
+ *
+ *        The pointers returned by the list are valid until the next call
+ *        that makes the file grow, `append`, or that moves the nodes,
+ *        `compact`.
+ *
+ * @var CD9PersistentList::fd The file descriptor of the file.
+ * @var CD9PersistentList::header The mapping of the file, it starts with the
+ *      header.
+ * @var CD9PersistentList::capacity The size of the file and of the mapping.
+ */
+typedef struct CD9PersistentList {
+    int fd;
+    CD9PersistentHeader *header;
+    size_t capacity;
+
+    /**
+     * @brief Use this function to append a copy of `data` at the end of the
+     *        list.
+     *
+     * @param self The current list.
+     * @param data The data you want to append.
+     * @param size The size of the data.
+     *
+     * @return int It returns `1` if the data was appended and `0` if the
+     *         file couldn't grow.
+     */
+    int (*append)(void *self, const void *data, size_t size);
+
+    /**
+     * @brief Use this function to get the data stored at `index`.
+     *
+     * @param self The current list.
+     * @param index The index of the element.
+     *
+     * @return void * The data or `NULL` if the index is not valid.
+     */
+    void *(*get)(void *self, size_t index);
+
+    /**
+     * @brief Use this function to get the index of the first element for
+     *        which `cmp` returns `true`, see \ref CD9List::find.
+     *
+     * @param self The current list.
+     * @param data The data you are looking for.
+     * @param cmp The comparator.
+     *
+     * @return int The index of the element or `-1` if there is no match.
+     */
+    int (*find)(void *self, const void *data, CD9FindCallback cmp);
+
+    /**
+     * @brief A wrapper over \ref find that compares the bytes of the
+     *        elements with the bytes of `data`.
+     *
+     * @param self The current list.
+     * @param data The data you are looking for.
+     *
+     * @return int The index of the element or `-1` if there is no match.
+     */
+    int (*findByValue)(void *self, const void *data);
+
+    /**
+     * @brief Use this function to remove the element at `index`. The space
+     *        of the element is given back only by \ref compact.
+     *
+     * @param self The current list.
+     * @param index The index of the element.
+     *
+     * @return int It returns `1` if the element was removed and `0` if the
+     *         index is not valid.
+     */
+    int (*remove)(void *self, size_t index);
+
+    /**
+     * @brief Use this function to write the changes to the disk. It waits
+     *        until the data is written.
+     *
+     * @param self The current list.
+     *
+     * @return int It returns `1` on success and `0` otherwise.
+     */
+    int (*sync)(void *self);
+
+    /**
+     * @brief Use this function to move the nodes next to each other, so the
+     *        space left by the removed elements is given back, and to shrink
+     *        the file to the space that is used. Call \ref sync first if
+     *        you can't afford to lose the list when the process crashes in
+     *        the middle of it.
+     *
+     * @param self The current list.
+     *
+     * @return int It returns `1` on success and `0` otherwise.
+     */
+    int (*compact)(void *self);
+} CD9PersistentList;
+
+/**
+ * @brief Use this macro to iterate over the nodes of a persistent list. The
+ *        variable `node` will be a `CD9PersistentNode *`. The walk stops
+ *        after the number of nodes told by the header, so a corrupt link
+ *        that makes a cycle doesn't make it loop forever.
+ */
+#define CD9PFOREACH(plist, node) \
+    for(uint64_t countP1 = 0, stopP1 = 1; stopP1 != 0; stopP1 = 0) \
+        for(CD9PersistentNode *node = cd9persistentlist_first(plist); \
+            node != NULL && countP1++ < (plist)->header->length; \
+            node = cd9persistentlist_next(plist, node))
+
+/**
+ * @brief Use this function to open the list stored in a file. If the file
+ *        doesn't exist or it is empty a new list is created.
+ *
+ * @param path The path of the file.
+ *
+ * @return CD9PersistentList * The list or `NULL` if the file can't be opened
+ *         or it doesn't hold a list. The head and the tail of the list are
+ *         checked, the links of the other nodes are checked as the list is
+ *         walked.
+ */
+CD9PersistentList *cd9persistentlist_open(const char *path);
+
+/**
+ * @brief Use this function to unmap and close the file of a list. The
+ *        changes are written to the disk by the system, call \ref sync
+ *        before if you need to know when it happens.
+ *
+ * @param plist The list.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9persistentlist_close(CD9PersistentList *plist);
+
+/**
+ * @brief Use this function to get the first node of a list.
+ *
+ * @param plist The list.
+ *
+ * @return CD9PersistentNode * The first node or `NULL` if the list is empty.
+ */
+CD9PersistentNode *cd9persistentlist_first(const CD9PersistentList *plist);
+
+/**
+ * @brief Use this function to get the node after `node`.
+ *
+ * @param plist The list.
+ * @param node A node of the list.
+ *
+ * @return CD9PersistentNode * The next node or `NULL` if `node` is the last
+ *         or its link points outside of the used part of the file.
+ */
+CD9PersistentNode *cd9persistentlist_next(const CD9PersistentList *plist,
+                                          const CD9PersistentNode *node);
+
+#endif // CD9PERSISTENTLIST_H__
@@ -0,0 +1,307 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "cd9list.h"
+#include "callbacks.h"
+#include "cd9query.h"
+
+/**
+ * @brief The state of `collect` while the query runs.
+ */
+typedef struct CD9QueryCollector {
+    CD9List *list;
+    CD9Node *tail;
+    bool failed;
+} CD9QueryCollector;
+
+/**
+ * @brief The state of `find` while the query runs.
+ */
+typedef struct CD9QueryFinder {
+    const void *data;
+    CD9FindCallback cmp;
+    int index;
+    bool found;
+} CD9QueryFinder;
+
+/**
+ * @brief Helper function that records a new stage.
+ *
+ * @return CD9Query * The query.
+ */
+CD9Query *cd9query_addStage(CD9Query *query, const CD9QueryStage *stage)
+{
+    if(query->length == query->capacity) {
+        size_t capacity       = (query->capacity == 0) ? 4 :
+                                query->capacity * 2;
+        CD9QueryStage *stages = realloc(query->stages,
+                                        capacity * sizeof(CD9QueryStage));
+
+        if(stages == NULL) { // Malloc failed.
+            query->failed = true;
+            return query;
+        }
+
+        query->stages   = stages;
+        query->capacity = capacity;
+    }
+
+    query->stages[query->length++] = *stage;
+
+    return query;
+}
+
+CD9Query *cd9query_filter(void *self, const void *data, CD9FindCallback cmp)
+{
+    CD9QueryStage stage = {.type = CD9QUERY_FILTER, .data = data, .cmp = cmp};
+
+    return cd9query_addStage(self, &stage);
+}
+
+CD9Query *cd9query_filterByValue(void *self, const void *data)
+{
+    CD9QueryStage stage = {.type = CD9QUERY_FILTER_BY_VALUE, .data = data};
+
+    return cd9query_addStage(self, &stage);
+}
+
+CD9Query *cd9query_filterBySet(void *self, CD9List *set)
+{
+    CD9QueryStage stage = {.type = CD9QUERY_FILTER_BY_SET, .set = set};
+
+    return cd9query_addStage(self, &stage);
+}
+
+CD9Query *cd9query_map(void *self, CD9MapCallback func, void *context)
+{
+    CD9QueryStage stage = {
+        .type = CD9QUERY_MAP, .map = func, .context = context
+    };
+
+    return cd9query_addStage(self, &stage);
+}
+
+CD9Query *cd9query_skip(void *self, size_t count)
+{
+    CD9QueryStage stage = {.type = CD9QUERY_SKIP, .count = count};
+
+    return cd9query_addStage(self, &stage);
+}
+
+CD9Query *cd9query_take(void *self, size_t count)
+{
+    CD9QueryStage stage = {.type = CD9QUERY_TAKE, .count = count};
+
+    return cd9query_addStage(self, &stage);
+}
+
+CD9Query *cd9query_step(void *self, size_t count)
+{
+    CD9QueryStage stage = {
+        .type = CD9QUERY_STEP, .count = (count != 0) ? count : 1
+    };
+
+    return cd9query_addStage(self, &stage);
+}
+
+/**
+ * @brief Helper function that runs every stage of the query on one element.
+ *
+ * @param query The query.
+ * @param item The data of the element, replaced by the `map` stages.
+ * @param size The size of the element, replaced by the `map` stages.
+ * @param done Set to `true` when no other element can get through the
+ *        stages.
+ *
+ * @return bool It returns `true` if the element got through every stage.
+ */
+bool cd9query_runStages(CD9Query   *query,
+                        const void **item,
+                        size_t     *size,
+                        bool       *done)
+{
+    for(size_t i = 0; i < query->length; i++) {
+        CD9QueryStage *stage = &query->stages[i];
+        bool keep            = true;
+
+        switch(stage->type) {
+        case CD9QUERY_FILTER:
+            keep = !stage->cmp(*item, stage->data, *size);
+            break;
+        case CD9QUERY_FILTER_BY_VALUE:
+            keep = (*size == SIZE_ZERO) ?
+                   !callbacks_findByAddressCmp(*item, stage->data, 0) :
+                   !callbacks_findByValueCmp(*item, stage->data, *size);
+            break;
+        case CD9QUERY_FILTER_BY_SET:
+            keep = ((*size == SIZE_ZERO) ?
+                    stage->set->findByAddress(stage->set, *item) :
+                    stage->set->findByValue(stage->set, *item)) == -1;
+            break;
+        case CD9QUERY_MAP:
+            *item = stage->map(*item, *size, stage->context, size);
+            break;
+        case CD9QUERY_SKIP:
+            keep = (stage->seen++ >= stage->count);
+            break;
+        case CD9QUERY_TAKE:
+            keep = (stage->seen++ < stage->count);
+
+            // The next elements would be dropped here, so we can stop.
+            if(stage->seen >= stage->count) {
+                *done = true;
+            }
+            break;
+        case CD9QUERY_STEP:
+            keep = (stage->seen++ % stage->count == 0);
+            break;
+        }
+
+        if(!keep) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t cd9query_forEach(void *self, CD9QueryCallback func, void *context)
+{
+    CD9Query *query = (CD9Query *)self;
+    size_t results  = 0;
+    bool done       = false;
+
+    if(query->failed) {
+        return 0;
+    }
+
+    for(size_t i = 0; i < query->length; i++) {
+        query->stages[i].seen = 0;
+    }
+
+    for(CD9Node *node = query->list->nodes; node != NULL && !done;
+        node = node->next) {
+        CD9PREFETCH_HINT(node);
+
+        const void *item = node->data;
+        size_t size      = cd9list_nodeSize(query->list, node);
+
+        if(!cd9query_runStages(query, &item, &size, &done)) {
+            continue;
+        }
+
+        results++;
+
+        if(!func(item, size, context)) {
+            break;
+        }
+    }
+
+    return results;
+}
+
+bool cd9query_collectItem(const void *item, size_t size, void *context)
+{
+    CD9QueryCollector *collector = context;
+    CD9Node *node = cd9list_createListNode(collector->list, item, size);
+
+    if(node == NULL) {
+        collector->failed = true;
+        return false;
+    }
+
+    if(collector->tail == NULL) {
+        collector->list->nodes = node;
+    }
+    else {
+        collector->tail->next = node;
+    }
+
+    collector->tail = node;
+    collector->list->length++;
+
+    return true;
+}
+
+CD9List *cd9query_collect(void *self)
+{
+    CD9Query *query = (CD9Query *)self;
+
+    if(query->failed) {
+        return NULL;
+    }
+
+    CD9QueryCollector collector = {
+        cd9list_createListLike(query->list), NULL, false
+    };
+
+    if(collector.list == NULL) {
+        return NULL;
+    }
+
+    cd9query_forEach(query, cd9query_collectItem, &collector);
+
+    if(collector.failed) {
+        cd9list_deleteList(collector.list);
+        return NULL;
+    }
+
+    return collector.list;
+}
+
+bool cd9query_findItem(const void *item, size_t size, void *context)
+{
+    CD9QueryFinder *finder = context;
+
+    if(finder->cmp(item, finder->data, size)) {
+        finder->found = true;
+        return false;
+    }
+
+    finder->index++;
+
+    return true;
+}
+
+int cd9query_find(void *self, const void *data, CD9FindCallback cmp)
+{
+    CD9QueryFinder finder = {data, cmp, 0, false};
+
+    cd9query_forEach(self, cd9query_findItem, &finder);
+
+    return finder.found ? finder.index : -1;
+}
+
+CD9Query *cd9query_create(CD9List *list)
+{
+    CD9Query *query = malloc(sizeof(CD9Query));
+    if(query == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    query->list     = list;
+    query->stages   = NULL;
+    query->length   = 0;
+    query->capacity = 0;
+    query->failed   = false;
+
+    // Now bind the functions.
+    query->filter        = cd9query_filter;
+    query->filterByValue = cd9query_filterByValue;
+    query->filterBySet   = cd9query_filterBySet;
+    query->map           = cd9query_map;
+    query->skip          = cd9query_skip;
+    query->take          = cd9query_take;
+    query->step          = cd9query_step;
+    query->collect       = cd9query_collect;
+    query->forEach       = cd9query_forEach;
+    query->find          = cd9query_find;
+
+    return query;
+}
+
+void cd9query_delete(CD9Query *query)
+{
+    free(query->stages);
+    free(query);
+}
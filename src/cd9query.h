@@ -0,0 +1,232 @@
+#ifndef CD9QUERY_H__
+#define CD9QUERY_H__
+
+#include <stdbool.h>
+#include "cd9list.h"
+
+/**
+ * @brief This is the callback of a `map` stage.
+ *
+ * @param item The data of an element.
+ * @param size The size of `item`, `0` if the element is an address.
+ * @param context The value passed to `map`.
+ * @param mappedSize Filled with the size of the result, `0` if the result
+ *        is an address that should be stored as it is.
+ *
+ * @return const void * The new element. It must stay valid until the next
+ *         call, so it can point to a buffer stored in `context`.
+ */
+typedef const void *(*CD9MapCallback)(const void *item,
+                                      size_t     size,
+                                      void       *context,
+                                      size_t     *mappedSize);
+
+/**
+ * @brief This is the callback of `forEach`.
+ *
+ * @param item The data of an element.
+ * @param size The size of `item`.
+ * @param context The value passed to `forEach`.
+ *
+ * @return bool Return `false` to stop the query.
+ */
+typedef bool (*CD9QueryCallback)(const void *item,
+                                 size_t     size,
+                                 void       *context);
+
+/**
+ * @brief The kinds of stages of a query.
+ */
+typedef enum CD9QueryStageType {
+    CD9QUERY_FILTER,
+    CD9QUERY_FILTER_BY_VALUE,
+    CD9QUERY_FILTER_BY_SET,
+    CD9QUERY_MAP,
+    CD9QUERY_SKIP,
+    CD9QUERY_TAKE,
+    CD9QUERY_STEP
+} CD9QueryStageType;
+
+/**
+ * @brief A stage of a query, only the members used by its type are set.
+ *
+ * @var CD9QueryStage::type The kind of the stage.
+ * @var CD9QueryStage::data The data passed to the comparator of a filter.
+ * @var CD9QueryStage::cmp The comparator of a `filter` stage.
+ * @var CD9QueryStage::set The list of a `filterBySet` stage.
+ * @var CD9QueryStage::map The callback of a `map` stage.
+ * @var CD9QueryStage::context The value passed to `map`.
+ * @var CD9QueryStage::count The number of elements of `skip` and `take`,
+ *      or the step of `step`.
+ * @var CD9QueryStage::seen The number of elements that got to the stage
+ *      during the current run.
+ */
+typedef struct CD9QueryStage {
+    CD9QueryStageType type;
+    const void *data;
+    CD9FindCallback cmp;
+    CD9List *set;
+    CD9MapCallback map;
+    void *context;
+    size_t count;
+    size_t seen;
+} CD9QueryStage;
+
+/**
+ * @brief A lazy query over a list. The stages are only recorded when they
+ *        are added, they are run by `collect`, `forEach` or `find` in a
+ *        single walk of the list, without building the lists in between.
+ *        The walk stops as soon as a `take` stage got all its elements. The
+ *        stages can be chained, since every one of them returns the query:
+ *
+ *        query->filterByValue(query, &key)->skip(query, 10)->take(query, 5);
+ *
+ * @var CD9Query::list The list the query reads.
+ * @var CD9Query::stages The stages, in the order they were added.
+ * @var CD9Query::length The number of stages.
+ * @var CD9Query::capacity The number of stages `stages` can hold.
+ * @var CD9Query::failed It is `true` if a stage couldn't be added.
+ */
+typedef struct CD9Query {
+    CD9List *list;
+    CD9QueryStage *stages;
+    size_t length;
+    size_t capacity;
+    bool failed;
+
+    /**
+     * @brief Similar to \ref CD9List::filter, the elements for which `cmp`
+     *        returns `true` are dropped.
+     *
+     * @param self The query.
+     * @param data This data will be passed to `cmp` at every call.
+     * @param cmp The comparator.
+     *
+     * @return CD9Query * The query.
+     */
+    struct CD9Query *(*filter)(void            *self,
+                               const void      *data,
+                               CD9FindCallback cmp);
+
+    /**
+     * @brief Similar to \ref CD9List::filterByValue, the elements equal to
+     *        `data` are dropped.
+     *
+     * @param self The query.
+     * @param data The value that is dropped.
+     *
+     * @return CD9Query * The query.
+     */
+    struct CD9Query *(*filterByValue)(void *self, const void *data);
+
+    /**
+     * @brief Similar to \ref CD9List::filterBySet, the elements found in
+     *        `set` are dropped.
+     *
+     * @param self The query.
+     * @param set The elements that are dropped.
+     *
+     * @return CD9Query * The query.
+     */
+    struct CD9Query *(*filterBySet)(void *self, CD9List *set);
+
+    /**
+     * @brief Use this function to replace every element by the result of
+     *        `func`.
+     *
+     * @param self The query.
+     * @param func The callback.
+     * @param context This value will be passed to `func` at every call.
+     *
+     * @return CD9Query * The query.
+     */
+    struct CD9Query *(*map)(void *self, CD9MapCallback func, void *context);
+
+    /**
+     * @brief Use this function to drop the first `count` elements.
+     *
+     * @param self The query.
+     * @param count The number of elements.
+     *
+     * @return CD9Query * The query.
+     */
+    struct CD9Query *(*skip)(void *self, size_t count);
+
+    /**
+     * @brief Use this function to keep only the first `count` elements.
+     *
+     * @param self The query.
+     * @param count The number of elements.
+     *
+     * @return CD9Query * The query.
+     */
+    struct CD9Query *(*take)(void *self, size_t count);
+
+    /**
+     * @brief Use this function to keep one element out of `count`, starting
+     *        with the first one, like the step of \ref CD9List::slice.
+     *
+     * @param self The query.
+     * @param count The step, `0` is treated like `1`.
+     *
+     * @return CD9Query * The query.
+     */
+    struct CD9Query *(*step)(void *self, size_t count);
+
+    /**
+     * @brief Use this function to run the query and get its elements in a
+     *        new list. The elements are copied like `appendCopy` does.
+     *
+     * @param self The query.
+     *
+     * @return CD9List * The list or `NULL` if the query couldn't be built or
+     *         malloc failed.
+     */
+    CD9List *(*collect)(void *self);
+
+    /**
+     * @brief Use this function to run the query and pass its elements to
+     *        `func`, without building a list.
+     *
+     * @param self The query.
+     * @param func The callback, it can stop the query by returning `false`.
+     * @param context This value will be passed to `func` at every call.
+     *
+     * @return size_t The number of elements passed to `func`.
+     */
+    size_t (*forEach)(void *self, CD9QueryCallback func, void *context);
+
+    /**
+     * @brief Use this function to run the query until the first element for
+     *        which `cmp` returns `true`.
+     *
+     * @param self The query.
+     * @param data The data you are looking for.
+     * @param cmp The comparator.
+     *
+     * @return int The index of the element in the results of the query or
+     *         `-1` if there is no match.
+     */
+    int (*find)(void *self, const void *data, CD9FindCallback cmp);
+} CD9Query;
+
+/**
+ * @brief Use this function to start a query over `list`. The list must not
+ *        change while the query runs.
+ *
+ * @param list The list.
+ *
+ * @return CD9Query * The query or `NULL` if malloc failed.
+ */
+CD9Query *cd9query_create(CD9List *list);
+
+/**
+ * @brief Use this function to free a query. The list is not deleted.
+ *
+ * @param query The query.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9query_delete(CD9Query *query);
+
+#endif // CD9QUERY_H__
@@ -0,0 +1,399 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "cd9list.h"
+#include "cd9arena.h"
+#include "cd9serialize.h"
+
+/**
+ * @brief The place the bytes of a serialized list are written to. Exactly
+ *        one of `file` and `buffer` is used.
+ */
+typedef struct CD9SerializeWriter {
+    FILE *file;
+    unsigned char *buffer;
+    size_t capacity;
+    size_t offset;
+} CD9SerializeWriter;
+
+/**
+ * @brief The place the bytes of a serialized list are read from. Exactly
+ *        one of `file` and `buffer` is used.
+ */
+typedef struct CD9SerializeReader {
+    FILE *file;
+    const unsigned char *buffer;
+    size_t size;
+    size_t offset;
+} CD9SerializeReader;
+
+bool cd9serialize_write(CD9SerializeWriter *writer,
+                        const void         *data,
+                        size_t             size)
+{
+    if(writer->file != NULL) {
+        return fwrite(data, 1, size, writer->file) == size;
+    }
+
+    if(writer->capacity - writer->offset < size) {
+        return false;
+    }
+
+    memcpy(writer->buffer + writer->offset, data, size);
+    writer->offset += size;
+
+    return true;
+}
+
+bool cd9serialize_read(CD9SerializeReader *reader, void *data, size_t size)
+{
+    if(reader->file != NULL) {
+        return fread(data, 1, size, reader->file) == size;
+    }
+
+    if(reader->size - reader->offset < size) {
+        return false;
+    }
+
+    memcpy(data, reader->buffer + reader->offset, size);
+    reader->offset += size;
+
+    return true;
+}
+
+void cd9serialize_encodeNumber(unsigned char *out, uint64_t value, size_t size)
+{
+    for(size_t i = 0; i < size; i++) {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+uint64_t cd9serialize_decodeNumber(const unsigned char *in, size_t size)
+{
+    uint64_t value = 0;
+
+    for(size_t i = 0; i < size; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+
+    return value;
+}
+
+/**
+ * @brief Helper function that writes `value` as a varint, 7 bits per byte,
+ *        the highest bit of a byte tells if there are more bytes.
+ *
+ * @return size_t The number of bytes used.
+ */
+size_t cd9serialize_encodeVarint(unsigned char *out, size_t value)
+{
+    size_t length = 0;
+
+    while(value >= 0x80) {
+        out[length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char)value;
+
+    return length;
+}
+
+size_t cd9serialize_varintSize(size_t value)
+{
+    size_t length = 1;
+
+    while(value >= 0x80) {
+        value >>= 7;
+        length++;
+    }
+
+    return length;
+}
+
+bool cd9serialize_readVarint(CD9SerializeReader *reader, size_t *value)
+{
+    unsigned char byte;
+    size_t shift = 0;
+
+    *value = 0;
+
+    do {
+        if(shift >= 64 || !cd9serialize_read(reader, &byte, 1)) {
+            return false;
+        }
+
+        *value |= (size_t)(byte & 0x7f) << shift;
+        shift  += 7;
+    } while(byte & 0x80);
+
+    return true;
+}
+
+void cd9serialize_encodeHeader(unsigned char *header, size_t count, size_t bytes)
+{
+    memcpy(header, CD9SERIALIZE_MAGIC, 4);
+    cd9serialize_encodeNumber(header + 4, CD9SERIALIZE_VERSION, 4);
+    cd9serialize_encodeNumber(header + 8, count, 8);
+    cd9serialize_encodeNumber(header + 16, bytes, 8);
+}
+
+bool cd9serialize_decodeHeader(const unsigned char *header,
+                               size_t              *count,
+                               size_t              *bytes)
+{
+    if(memcmp(header, CD9SERIALIZE_MAGIC, 4) != 0 ||
+       cd9serialize_decodeNumber(header + 4, 4) != CD9SERIALIZE_VERSION) {
+        return false;
+    }
+
+    *count = cd9serialize_decodeNumber(header + 8, 8);
+    *bytes = cd9serialize_decodeNumber(header + 16, 8);
+
+    return true;
+}
+
+/**
+ * @brief Helper function that counts the total number of bytes of the
+ *        elements of a list.
+ *
+ * @return bool It returns `false` if the list has elements that are not
+ *         copies, they can't be serialized.
+ */
+bool cd9serialize_countBytes(const CD9List *list, size_t *bytes)
+{
+    *bytes = 0;
+
+    CD9FOREACH_(list, node) {
+        size_t size = cd9list_nodeSize(list, node);
+
+        if(size == SIZE_ZERO) {
+            return false;
+        }
+
+        *bytes += size;
+    }
+
+    return true;
+}
+
+int cd9serialize_writeList(const CD9List *list, CD9SerializeWriter *writer)
+{
+    unsigned char header[CD9SERIALIZE_HEADER_SIZE];
+    size_t bytes;
+
+    if(!cd9serialize_countBytes(list, &bytes)) {
+        return 0;
+    }
+
+    cd9serialize_encodeHeader(header, list->length, bytes);
+    if(!cd9serialize_write(writer, header, CD9SERIALIZE_HEADER_SIZE)) {
+        return 0;
+    }
+
+    CD9FOREACH_(list, node) {
+        unsigned char size[10];
+        size_t dataSize = cd9list_nodeSize(list, node);
+        size_t length   = cd9serialize_encodeVarint(size, dataSize);
+
+        if(!cd9serialize_write(writer, size, length) ||
+           !cd9serialize_write(writer, node->data, dataSize)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Helper function that reads an element of `size` bytes in the arena
+ *        of `list`. The memory of the big elements read from a file grows
+ *        with the bytes that actually arrive, see
+ *        \ref CD9SERIALIZE_MAX_BLOCK_SIZE.
+ *
+ * @return void * The copy or `NULL` if the bytes can't be read or malloc
+ *         failed.
+ */
+void *cd9serialize_readData(CD9SerializeReader *reader,
+                            CD9List            *list,
+                            size_t             size)
+{
+    if(reader->file == NULL || size <= CD9SERIALIZE_MAX_BLOCK_SIZE) {
+        void *data = cd9arena_alloc(list->arena, size);
+
+        if(data == NULL || !cd9serialize_read(reader, data, size)) {
+            return NULL;
+        }
+
+        return data;
+    }
+
+    unsigned char *buffer = NULL;
+    size_t done           = 0;
+
+    while(done < size) {
+        size_t chunk = size - done;
+
+        if(chunk > CD9SERIALIZE_MAX_BLOCK_SIZE) {
+            chunk = CD9SERIALIZE_MAX_BLOCK_SIZE;
+        }
+
+        unsigned char *grown = realloc(buffer, done + chunk);
+        if(grown == NULL) { // Malloc failed.
+            free(buffer);
+            return NULL;
+        }
+
+        buffer = grown;
+
+        if(!cd9serialize_read(reader, buffer + done, chunk)) {
+            free(buffer);
+            return NULL;
+        }
+
+        done += chunk;
+    }
+
+    void *data = cd9arena_alloc(list->arena, size);
+    if(data != NULL) {
+        memcpy(data, buffer, size);
+    }
+
+    free(buffer);
+
+    return data;
+}
+
+CD9List *cd9serialize_readList(CD9SerializeReader *reader)
+{
+    unsigned char header[CD9SERIALIZE_HEADER_SIZE];
+    size_t count;
+    size_t bytes;
+
+    if(!cd9serialize_read(reader, header, CD9SERIALIZE_HEADER_SIZE) ||
+       !cd9serialize_decodeHeader(header, &count, &bytes)) {
+        return NULL;
+    }
+
+    // Enough for every node and every copy, including the padding the arena
+    // adds after them, so they all end up in the same block.
+    size_t nodeSize  = cd9arena_align(sizeof(CD9Node));
+    size_t blockSize = count * (nodeSize + CD9ARENA_ALIGNMENT - 1) + bytes;
+
+    if(count > bytes || (count != 0 && blockSize / count < nodeSize)) {
+        return NULL; // Every element has at least one byte, or it overflows.
+    }
+
+    if(reader->file == NULL) {
+        size_t left = reader->size - reader->offset;
+
+        // Every element takes at least one byte for its size, besides its
+        // bytes, so the rest of the buffer must hold all of them.
+        if(bytes > left || count > left - bytes) {
+            return NULL;
+        }
+    }
+    else if(blockSize > CD9SERIALIZE_MAX_BLOCK_SIZE) {
+        blockSize = CD9SERIALIZE_MAX_BLOCK_SIZE;
+    }
+
+    CD9List *list = cd9list_createArenaList(blockSize);
+    if(list == NULL) {
+        return NULL;
+    }
+
+    CD9Node *tail = NULL;
+
+    for(size_t i = 0; i < count; i++) {
+        size_t size;
+
+        if(!cd9serialize_readVarint(reader, &size) || size == 0 ||
+           size > bytes) {
+            cd9list_deleteList(list);
+            return NULL;
+        }
+
+        CD9Node *node = cd9arena_alloc(list->arena, sizeof(CD9Node));
+        void *data    = (node != NULL) ?
+                        cd9serialize_readData(reader, list, size) : NULL;
+
+        if(data == NULL) {
+            cd9list_deleteList(list);
+            return NULL;
+        }
+
+        node->data = data;
+        node->size = size;
+        node->next = NULL;
+
+        if(tail == NULL) {
+            list->nodes = node;
+        }
+        else {
+            tail->next = node;
+        }
+
+        tail   = node;
+        bytes -= size;
+        list->length++;
+    }
+
+    if(bytes != 0) { // The header doesn't match the elements.
+        cd9list_deleteList(list);
+        return NULL;
+    }
+
+    return list;
+}
+
+size_t cd9list_serializedSize(const CD9List *list)
+{
+    size_t size = CD9SERIALIZE_HEADER_SIZE;
+
+    CD9FOREACH_(list, node) {
+        size_t bytes = cd9list_nodeSize(list, node);
+
+        if(bytes == SIZE_ZERO) {
+            return 0;
+        }
+
+        size += cd9serialize_varintSize(bytes) + bytes;
+    }
+
+    return size;
+}
+
+int cd9list_serialize(const CD9List *list, FILE *file)
+{
+    CD9SerializeWriter writer = {file, NULL, 0, 0};
+
+    return cd9serialize_writeList(list, &writer);
+}
+
+size_t cd9list_serializeToBuffer(const CD9List *list,
+                                 void          *buffer,
+                                 size_t        capacity)
+{
+    CD9SerializeWriter writer = {NULL, buffer, capacity, 0};
+
+    if(!cd9serialize_writeList(list, &writer)) {
+        return 0;
+    }
+
+    return writer.offset;
+}
+
+CD9List *cd9list_deserialize(FILE *file)
+{
+    CD9SerializeReader reader = {file, NULL, 0, 0};
+
+    return cd9serialize_readList(&reader);
+}
+
+CD9List *cd9list_deserializeFromBuffer(const void *buffer, size_t size)
+{
+    CD9SerializeReader reader = {NULL, buffer, size, 0};
+
+    return cd9serialize_readList(&reader);
+}
@@ -0,0 +1,109 @@
+#ifndef CD9SERIALIZE_H__
+#define CD9SERIALIZE_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "cd9list.h"
+
+/**
+ * @brief The first bytes of every serialized list.
+ */
+#define CD9SERIALIZE_MAGIC "CD9L"
+
+/**
+ * @brief The version of the format written by this library.
+ */
+#define CD9SERIALIZE_VERSION 1
+
+/**
+ * @brief The size of the header of a serialized list. The header holds the
+ *        magic, the version, the number of elements and the total number of
+ *        bytes of the elements, the numbers are stored in little endian.
+ *        After the header every element is stored as its size, encoded as a
+ *        varint, followed by its bytes.
+ */
+#define CD9SERIALIZE_HEADER_SIZE 24
+
+/**
+ * @brief The biggest block a list read from a file starts with. The header
+ *        of a file can't be checked against the size of the file, so the
+ *        arena grows as the elements arrive instead, and the elements bigger
+ *        than this are read in chunks of this size.
+ */
+#define CD9SERIALIZE_MAX_BLOCK_SIZE (1024 * 1024)
+
+/**
+ * @brief Use this function to read the header of a serialized list. This
+ *        function is intended to be used internally.
+ *
+ * @param header The first \ref CD9SERIALIZE_HEADER_SIZE bytes.
+ * @param count Filled with the number of elements.
+ * @param bytes Filled with the total number of bytes of the elements.
+ *
+ * @return bool It returns `false` if the header is not valid.
+ */
+bool cd9serialize_decodeHeader(const unsigned char *header,
+                               size_t              *count,
+                               size_t              *bytes);
+
+/**
+ * @brief Use this function to get the number of bytes needed to serialize a
+ *        list.
+ *
+ * @param list The list.
+ *
+ * @return size_t The number of bytes or `0` if the list can't be serialized.
+ *         Only lists of copies can be serialized, see `appendCopy`, the
+ *         lists of addresses can't.
+ */
+size_t cd9list_serializedSize(const CD9List *list);
+
+/**
+ * @brief Use this function to write a list to a file. The writes go through
+ *        the buffer of `file`, so it can be a pipe or a socket as well.
+ *
+ * @param list The list you want to write. It must be a list of copies.
+ * @param file The file, opened for writing in binary mode.
+ *
+ * @return int It returns `1` if the list was written and `0` otherwise.
+ */
+int cd9list_serialize(const CD9List *list, FILE *file);
+
+/**
+ * @brief Use this function to write a list to a buffer.
+ *
+ * @param list The list you want to write. It must be a list of copies.
+ * @param buffer The buffer.
+ * @param capacity The size of the buffer, see `cd9list_serializedSize`.
+ *
+ * @return size_t The number of bytes written or `0` if the list can't be
+ *         serialized or it doesn't fit in the buffer.
+ */
+size_t cd9list_serializeToBuffer(const CD9List *list,
+                                 void          *buffer,
+                                 size_t        capacity);
+
+/**
+ * @brief Use this function to read a list written by `cd9list_serialize`.
+ *        The list owns an arena, see `cd9list_createArenaList`, and all its
+ *        nodes and copies are read in a single block of it.
+ *
+ * @param file The file, opened for reading in binary mode.
+ *
+ * @return CD9List * The list or `NULL` if the file is not a valid list.
+ */
+CD9List *cd9list_deserialize(FILE *file);
+
+/**
+ * @brief Similar to `cd9list_deserialize`, but the list is read from a
+ *        buffer.
+ *
+ * @param buffer The buffer.
+ * @param size The size of the buffer.
+ *
+ * @return CD9List * The list or `NULL` if the buffer is not a valid list.
+ */
+CD9List *cd9list_deserializeFromBuffer(const void *buffer, size_t size);
+
+#endif // CD9SERIALIZE_H__
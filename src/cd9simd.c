@@ -0,0 +1,282 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "cd9simd.h"
+
+#if defined(__GNUC__) && \
+    (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define CD9SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief The number of bytes compared at once by the kernels, every size
+ *        handled by the kernels divides it.
+ */
+#define CD9SIMD_BLOCK 32
+
+/**
+ * @brief A kernel. It compares the elements with `pattern`, which holds the
+ *        key repeated over \ref CD9SIMD_BLOCK bytes. If `bitmap` is `NULL`
+ *        it stops at the first match and stores its index in `first`.
+ *
+ * @return size_t The number of matches.
+ */
+typedef size_t (*CD9SimdScan)(const unsigned char *base,
+                              size_t              count,
+                              size_t              width,
+                              const unsigned char *pattern,
+                              uint64_t            *bitmap,
+                              size_t              *first);
+
+/**
+ * @brief Helper function that compares the elements from `from` to `count`
+ *        one by one. It handles the elements left after the last block and
+ *        the machines without a kernel.
+ */
+size_t cd9simd_scanTail(const unsigned char *base,
+                        size_t              from,
+                        size_t              count,
+                        size_t              width,
+                        const unsigned char *key,
+                        uint64_t            *bitmap,
+                        size_t              *first)
+{
+    size_t matches = 0;
+
+    for(size_t i = from; i < count; i++) {
+        if(memcmp(base + i * width, key, width) != 0) {
+            continue;
+        }
+
+        if(bitmap == NULL) {
+            *first = i;
+            return 1;
+        }
+
+        bitmap[i / 64] |= (uint64_t)1 << (i % 64);
+        matches++;
+    }
+
+    return matches;
+}
+
+size_t cd9simd_scanScalar(const unsigned char *base,
+                          size_t              count,
+                          size_t              width,
+                          const unsigned char *pattern,
+                          uint64_t            *bitmap,
+                          size_t              *first)
+{
+    return cd9simd_scanTail(base, 0, count, width, pattern, bitmap, first);
+}
+
+#ifdef CD9SIMD_X86
+/**
+ * @brief Helper function that turns the byte mask of a block, one bit for
+ *        every byte equal to the pattern, into the bits of the elements of
+ *        the block. It marks the matches and returns `true` if the scan
+ *        should stop.
+ *
+ * @param mask The byte mask of the block.
+ * @param width The size of an element.
+ * @param index The index of the first element of the block.
+ */
+bool cd9simd_collect(uint32_t mask,
+                     size_t   width,
+                     size_t   index,
+                     uint64_t *bitmap,
+                     size_t   *first,
+                     size_t   *matches)
+{
+    // The bits at the multiples of `width`, one for every element.
+    static const uint32_t positions[CD9SIMD_MAX_WIDTH + 1] = {
+        [1] = 0xffffffff, [2] = 0x55555555, [4] = 0x11111111,
+        [8] = 0x01010101, [16] = 0x00010001, [32] = 0x00000001
+    };
+
+    // After this the first bit of an element is set only if all its bytes
+    // are equal.
+    for(size_t shift = 1; shift < width; shift *= 2) {
+        mask &= mask >> shift;
+    }
+
+    mask &= positions[width];
+
+    while(mask != 0) {
+        size_t element = index + __builtin_ctz(mask) / width;
+
+        if(bitmap == NULL) {
+            *first   = element;
+            *matches = 1;
+            return true;
+        }
+
+        bitmap[element / 64] |= (uint64_t)1 << (element % 64);
+        (*matches)++;
+        mask &= mask - 1;
+    }
+
+    return false;
+}
+
+size_t cd9simd_scanSse2(const unsigned char *base,
+                        size_t              count,
+                        size_t              width,
+                        const unsigned char *pattern,
+                        uint64_t            *bitmap,
+                        size_t              *first)
+{
+    __m128i low     = _mm_loadu_si128((const __m128i *)pattern);
+    __m128i high    = _mm_loadu_si128((const __m128i *)(pattern + 16));
+    size_t blocks   = count * width / CD9SIMD_BLOCK;
+    size_t perBlock = CD9SIMD_BLOCK / width;
+    size_t matches  = 0;
+
+    for(size_t b = 0; b < blocks; b++) {
+        const __m128i *block = (const __m128i *)(base + b * CD9SIMD_BLOCK);
+        uint32_t lowMask     = _mm_movemask_epi8(
+                                   _mm_cmpeq_epi8(_mm_loadu_si128(block),
+                                                  low));
+        uint32_t highMask    = _mm_movemask_epi8(
+                                   _mm_cmpeq_epi8(_mm_loadu_si128(block + 1),
+                                                  high));
+        uint32_t mask        = lowMask | highMask << 16;
+
+        if(mask != 0 && cd9simd_collect(mask, width, b * perBlock, bitmap,
+                                        first, &matches)) {
+            return matches;
+        }
+    }
+
+    return matches + cd9simd_scanTail(base, blocks * perBlock, count, width,
+                                      pattern, bitmap, first);
+}
+
+__attribute__((target("avx2")))
+size_t cd9simd_scanAvx2(const unsigned char *base,
+                        size_t              count,
+                        size_t              width,
+                        const unsigned char *pattern,
+                        uint64_t            *bitmap,
+                        size_t              *first)
+{
+    __m256i key     = _mm256_loadu_si256((const __m256i *)pattern);
+    size_t blocks   = count * width / CD9SIMD_BLOCK;
+    size_t perBlock = CD9SIMD_BLOCK / width;
+    size_t matches  = 0;
+
+    for(size_t b = 0; b < blocks; b++) {
+        const __m256i *block = (const __m256i *)(base + b * CD9SIMD_BLOCK);
+        uint32_t mask        = _mm256_movemask_epi8(
+                                   _mm256_cmpeq_epi8(_mm256_loadu_si256(block),
+                                                     key));
+
+        if(mask != 0 && cd9simd_collect(mask, width, b * perBlock, bitmap,
+                                        first, &matches)) {
+            return matches;
+        }
+    }
+
+    return matches + cd9simd_scanTail(base, blocks * perBlock, count, width,
+                                      pattern, bitmap, first);
+}
+#endif
+
+/**
+ * @brief The kernel for this machine, see `cd9simd_kernel`.
+ */
+static CD9SimdScan cd9simd_pickedKernel = NULL;
+
+/**
+ * @brief Makes sure the kernel is picked once, even when the first calls
+ *        come from several threads at the same time.
+ */
+static pthread_once_t cd9simd_kernelOnce = PTHREAD_ONCE_INIT;
+
+void cd9simd_pickKernel()
+{
+#ifdef CD9SIMD_X86
+    cd9simd_pickedKernel = __builtin_cpu_supports("avx2") ? cd9simd_scanAvx2 :
+                                                            cd9simd_scanSse2;
+#else
+    cd9simd_pickedKernel = cd9simd_scanScalar;
+#endif
+}
+
+/**
+ * @brief Helper function that returns the kernel for this machine. It is
+ *        picked on the first call.
+ */
+CD9SimdScan cd9simd_kernel()
+{
+    pthread_once(&cd9simd_kernelOnce, cd9simd_pickKernel);
+
+    return cd9simd_pickedKernel;
+}
+
+bool cd9simd_supportsWidth(size_t width)
+{
+    return width != 0 && width <= CD9SIMD_MAX_WIDTH &&
+           (width & (width - 1)) == 0;
+}
+
+const char *cd9simd_kernelName()
+{
+#ifdef CD9SIMD_X86
+    if(cd9simd_kernel() == cd9simd_scanAvx2) {
+        return "avx2";
+    }
+
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+/**
+ * @brief Helper function that runs the kernel, or the scalar loop for the
+ *        sizes without a kernel.
+ */
+size_t cd9simd_scan(const void *base,
+                    size_t     count,
+                    size_t     width,
+                    const void *key,
+                    uint64_t   *bitmap,
+                    size_t     *first)
+{
+    if(!cd9simd_supportsWidth(width)) {
+        return cd9simd_scanTail(base, 0, count, width, key, bitmap, first);
+    }
+
+    unsigned char pattern[CD9SIMD_BLOCK];
+
+    for(size_t i = 0; i < CD9SIMD_BLOCK; i += width) {
+        memcpy(pattern + i, key, width);
+    }
+
+    return cd9simd_kernel()(base, count, width, pattern, bitmap, first);
+}
+
+int cd9simd_find(const void *base, size_t count, size_t width,
+                 const void *key)
+{
+    size_t first;
+
+    if(cd9simd_scan(base, count, width, key, NULL, &first) == 0) {
+        return -1;
+    }
+
+    return first;
+}
+
+size_t cd9simd_match(const void *base, size_t count, size_t width,
+                     const void *key, uint64_t *bitmap)
+{
+    memset(bitmap, 0, (count + 63) / 64 * sizeof(uint64_t));
+
+    return cd9simd_scan(base, count, width, key, bitmap, NULL);
+}
@@ -0,0 +1,66 @@
+#ifndef CD9SIMD_H__
+#define CD9SIMD_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief The biggest element handled by the vectorized kernels. The kernels
+ *        handle the elements of 1, 2, 4, 8, 16 and 32 bytes.
+ */
+#define CD9SIMD_MAX_WIDTH 32
+
+/**
+ * @brief Use this function to know if the kernels can handle elements of
+ *        `width` bytes.
+ *
+ * @param width The size of an element.
+ *
+ * @return bool It returns `true` if there is a kernel for `width`.
+ */
+bool cd9simd_supportsWidth(size_t width);
+
+/**
+ * @brief Use this function to get the name of the instruction set picked
+ *        at runtime by the kernels.
+ *
+ * @return const char * It returns "avx2", "sse2" or "scalar".
+ */
+const char *cd9simd_kernelName();
+
+/**
+ * @brief Use this function to find `key` in an array of elements stored
+ *        next to each other. The kernels only pay off on such arrays, the
+ *        lists compare their elements in place, see \ref CD9List::findByValue.
+ *
+ * @param base The first element.
+ * @param count The number of elements.
+ * @param width The size of an element and of `key`. The other sizes than
+ *        the ones accepted by `cd9simd_supportsWidth` are compared with
+ *        `memcmp`.
+ * @param key The element you are looking for.
+ *
+ * @return int The index of the first element equal to `key` or `-1`.
+ */
+int cd9simd_find(const void *base, size_t count, size_t width,
+                 const void *key);
+
+/**
+ * @brief Similar to `cd9simd_find`, but it marks all the elements equal to
+ *        `key`.
+ *
+ * @param base The first element.
+ * @param count The number of elements.
+ * @param width The size of an element and of `key`.
+ * @param key The element you are looking for.
+ * @param bitmap Filled with a bit for every element, the bit `i % 64` of the
+ *        word `i / 64` is set if the element `i` is equal to `key`. It must
+ *        hold `(count + 63) / 64` words.
+ *
+ * @return size_t The number of elements equal to `key`.
+ */
+size_t cd9simd_match(const void *base, size_t count, size_t width,
+                     const void *key, uint64_t *bitmap);
+
+#endif // CD9SIMD_H__
@@ -0,0 +1,414 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "cd9list.h"
+#include "cd9sortedlist.h"
+
+/**
+ * @brief Helper function used to pick the height of a new tower. Every
+ *        element is promoted to the next lane with a probability of 1/4, so
+ *        most of the elements don't get a tower at all.
+ *
+ * @param sortedList The sorted list that owns the generator.
+ *
+ * @return size_t The number of lanes the new tower will take part in.
+ */
+size_t cd9sortedlist_randomHeight(CD9SortedList *sortedList)
+{
+    size_t height = 0;
+
+    while(height < CD9SORTEDLIST_MAX_LEVEL) {
+        // xorshift32, we don't need anything better than this.
+        sortedList->seed ^= sortedList->seed << 13;
+        sortedList->seed ^= sortedList->seed >> 17;
+        sortedList->seed ^= sortedList->seed << 5;
+
+        if((sortedList->seed & 3) != 0) {
+            break;
+        }
+
+        height++;
+    }
+
+    return height;
+}
+
+/**
+ * @brief This is the function used by all the lookups. It walks the lanes,
+ *        from the highest to the lowest, and then the list itself until it
+ *        finds the position where `data` belongs.
+ *
+ * @param sortedList The sorted list.
+ * @param data The value we are looking for.
+ * @param upper If it is `true` the position will be after the elements equal
+ *        to `data`, otherwise it will be before them.
+ * @param update Filled with the last tower visited on every lane.
+ * @param ranks Filled with the rank of the towers from `update`. The rank of
+ *        the head is `0` and the rank of the element at index `i` is `i + 1`.
+ * @param prev Filled with the node right before the position or `NULL` if
+ *        the position is at the beginning of the list.
+ *
+ * @return size_t The index of the position.
+ */
+size_t cd9sortedlist_search(const CD9SortedList *sortedList,
+                            const void          *data,
+                            bool                upper,
+                            CD9SkipNode         **update,
+                            size_t              *ranks,
+                            CD9Node             **prev)
+{
+    CD9SkipNode *tower = sortedList->head;
+    size_t rank        = 0;
+
+    for(size_t i = CD9SORTEDLIST_MAX_LEVEL; i-- > 0;) {
+        while(i < sortedList->level && tower->links[i].next != NULL) {
+            int result = sortedList->cmp(tower->links[i].next->node->data,
+                                         data);
+            if(result > 0 || (result == 0 && !upper)) {
+                break;
+            }
+
+            rank += tower->links[i].width;
+            tower = tower->links[i].next;
+        }
+
+        update[i] = tower;
+        ranks[i]  = rank;
+    }
+
+    CD9Node *node = (tower == sortedList->head) ? NULL : tower->node;
+    CD9Node *next = (node == NULL) ? sortedList->list->nodes : node->next;
+
+    while(next != NULL) {
+        int result = sortedList->cmp(next->data, data);
+        if(result > 0 || (result == 0 && !upper)) {
+            break;
+        }
+
+        node = next;
+        next = next->next;
+        rank++;
+    }
+
+    *prev = node;
+
+    return rank;
+}
+
+/**
+ * @brief Helper function that links an already created node in the list and
+ *        builds a tower for it if it is lucky enough.
+ *
+ * @param sortedList The sorted list.
+ * @param node The node that should be linked.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9sortedlist_insertNode(CD9SortedList *sortedList, CD9Node *node)
+{
+    CD9SkipNode *update[CD9SORTEDLIST_MAX_LEVEL];
+    size_t ranks[CD9SORTEDLIST_MAX_LEVEL];
+    CD9Node *prev;
+
+    size_t index = cd9sortedlist_search(sortedList, node->data, true, update,
+                                        ranks, &prev);
+
+    if(prev == NULL) {
+        node->next = sortedList->list->nodes;
+        sortedList->list->nodes = node;
+    }
+    else {
+        node->next = prev->next;
+        prev->next = node;
+    }
+    sortedList->list->length++;
+
+    size_t height      = cd9sortedlist_randomHeight(sortedList);
+    size_t rank        = index + 1;
+    CD9SkipNode *tower = NULL;
+
+    if(height > 0) {
+        tower = malloc(sizeof(CD9SkipNode) + height * sizeof(CD9SkipLink));
+        if(tower == NULL) { // Malloc failed, the node just won't have a tower.
+            height = 0;
+        }
+        else {
+            tower->node   = node;
+            tower->height = height;
+        }
+    }
+
+    if(height > sortedList->level) {
+        sortedList->level = height;
+    }
+
+    for(size_t i = 0; i < sortedList->level; i++) {
+        CD9SkipLink *link = &update[i]->links[i];
+
+        if(i < height) {
+            tower->links[i].next  = link->next;
+            tower->links[i].width = (link->next != NULL) ?
+                                    ranks[i] + link->width + 1 - rank : 0;
+
+            link->next  = tower;
+            link->width = rank - ranks[i];
+        }
+        else if(link->next != NULL) {
+            // The new node is somewhere under this link.
+            link->width++;
+        }
+    }
+}
+
+bool cd9sortedlist_insertSorted(void *self, const void *data)
+{
+    CD9SortedList *sortedList = (CD9SortedList *)self;
+    CD9Node *node             = cd9list_createListNode(sortedList->list,
+                                                       data, SIZE_ZERO);
+
+    if(node == NULL) { // Malloc failed.
+        return false;
+    }
+
+    cd9sortedlist_insertNode(sortedList, node);
+
+    return true;
+}
+
+bool cd9sortedlist_insertSortedCopy(void *self, const void *data, size_t size)
+{
+    CD9SortedList *sortedList = (CD9SortedList *)self;
+    CD9Node *node             = cd9list_createListNode(sortedList->list,
+                                                       data, size);
+
+    if(node == NULL) { // Malloc failed.
+        return false;
+    }
+
+    cd9sortedlist_insertNode(sortedList, node);
+
+    return true;
+}
+
+size_t cd9sortedlist_lowerBound(void *self, const void *data)
+{
+    CD9SortedList *sortedList = (CD9SortedList *)self;
+    CD9SkipNode *update[CD9SORTEDLIST_MAX_LEVEL];
+    size_t ranks[CD9SORTEDLIST_MAX_LEVEL];
+    CD9Node *prev;
+
+    return cd9sortedlist_search(sortedList, data, false, update, ranks, &prev);
+}
+
+size_t cd9sortedlist_upperBound(void *self, const void *data)
+{
+    CD9SortedList *sortedList = (CD9SortedList *)self;
+    CD9SkipNode *update[CD9SORTEDLIST_MAX_LEVEL];
+    size_t ranks[CD9SORTEDLIST_MAX_LEVEL];
+    CD9Node *prev;
+
+    return cd9sortedlist_search(sortedList, data, true, update, ranks, &prev);
+}
+
+int cd9sortedlist_findSorted(void *self, const void *data)
+{
+    CD9SortedList *sortedList = (CD9SortedList *)self;
+    CD9SkipNode *update[CD9SORTEDLIST_MAX_LEVEL];
+    size_t ranks[CD9SORTEDLIST_MAX_LEVEL];
+    CD9Node *prev;
+
+    size_t index  = cd9sortedlist_search(sortedList, data, false, update,
+                                         ranks, &prev);
+    CD9Node *node = (prev == NULL) ? sortedList->list->nodes : prev->next;
+
+    if(node != NULL && sortedList->cmp(node->data, data) == 0) {
+        return index;
+    }
+
+    return -1;
+}
+
+void *cd9sortedlist_get(void *self, size_t index)
+{
+    CD9SortedList *sortedList = (CD9SortedList *)self;
+
+    if(index >= sortedList->list->length) {
+        return NULL;
+    }
+
+    CD9SkipNode *tower = sortedList->head;
+    size_t target      = index + 1;
+    size_t rank        = 0;
+
+    for(size_t i = sortedList->level; i-- > 0;) {
+        while(tower->links[i].next != NULL &&
+              rank + tower->links[i].width <= target) {
+            rank += tower->links[i].width;
+            tower = tower->links[i].next;
+        }
+    }
+
+    CD9Node *node = sortedList->list->nodes;
+    if(tower != sortedList->head) {
+        node = tower->node;
+    }
+    else {
+        rank = 1;
+    }
+
+    while(rank < target) {
+        node = node->next;
+        rank++;
+    }
+
+    return node->data;
+}
+
+int cd9sortedlist_removeSorted(void *self, const void *data)
+{
+    CD9SortedList *sortedList = (CD9SortedList *)self;
+    CD9SkipNode *update[CD9SORTEDLIST_MAX_LEVEL];
+    size_t ranks[CD9SORTEDLIST_MAX_LEVEL];
+    CD9Node *prev;
+
+    cd9sortedlist_search(sortedList, data, false, update, ranks, &prev);
+    CD9Node *toDelete = (prev == NULL) ? sortedList->list->nodes : prev->next;
+
+    if(toDelete == NULL || sortedList->cmp(toDelete->data, data) != 0) {
+        return 0; // There is nothing to remove.
+    }
+
+    CD9SkipNode *tower = NULL;
+
+    for(size_t i = 0; i < sortedList->level; i++) {
+        CD9SkipLink *link = &update[i]->links[i];
+
+        if(link->next != NULL && link->next->node == toDelete) {
+            tower = link->next;
+
+            link->width = (tower->links[i].next != NULL) ?
+                          link->width + tower->links[i].width - 1 : 0;
+            link->next  = tower->links[i].next;
+        }
+        else if(link->next != NULL) {
+            link->width--;
+        }
+    }
+
+    free(tower);
+
+    while(sortedList->level > 0 &&
+          sortedList->head->links[sortedList->level - 1].next == NULL) {
+        sortedList->level--;
+    }
+
+    if(prev == NULL) {
+        sortedList->list->nodes = toDelete->next;
+    }
+    else {
+        prev->next = toDelete->next;
+    }
+
+    cd9list_deleteListNode(sortedList->list, toDelete);
+    sortedList->list->length--;
+
+    return 1;
+}
+
+CD9List *cd9sortedlist_range(void *self, const void *low, const void *high)
+{
+    CD9SortedList *sortedList = (CD9SortedList *)self;
+    CD9List *result           = cd9list_createListLike(sortedList->list);
+    CD9SkipNode *update[CD9SORTEDLIST_MAX_LEVEL];
+    size_t ranks[CD9SORTEDLIST_MAX_LEVEL];
+    CD9Node *prev;
+
+    if(result == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    cd9sortedlist_search(sortedList, low, false, update, ranks, &prev);
+
+    CD9Node *node = (prev == NULL) ? sortedList->list->nodes : prev->next;
+    CD9Node *tail = NULL;
+
+    // We keep track of the tail, so we don't have to walk the result list
+    // for every element we append.
+    while(node != NULL && sortedList->cmp(node->data, high) <= 0) {
+        size_t size   = cd9list_nodeSize(sortedList->list, node);
+        CD9Node *copy = cd9list_createListNode(result, node->data, size);
+        if(copy == NULL) { // Malloc failed.
+            cd9list_deleteList(result);
+            return NULL;
+        }
+
+        if(tail == NULL) {
+            result->nodes = copy;
+        }
+        else {
+            tail->next = copy;
+        }
+
+        tail = copy;
+        result->length++;
+        node = node->next;
+    }
+
+    return result;
+}
+
+CD9SortedList *cd9sortedlist_createList(CD9CompareCallback cmp)
+{
+    CD9SortedList *sortedList = malloc(sizeof(CD9SortedList));
+    if(sortedList == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    sortedList->list = cd9list_createList();
+    sortedList->head = calloc(1, sizeof(CD9SkipNode) +
+                              CD9SORTEDLIST_MAX_LEVEL * sizeof(CD9SkipLink));
+
+    if(sortedList->list == NULL || sortedList->head == NULL) {
+        if(sortedList->list != NULL) {
+            cd9list_deleteList(sortedList->list);
+        }
+        free(sortedList->head);
+        free(sortedList);
+
+        return NULL;
+    }
+
+    sortedList->head->height = CD9SORTEDLIST_MAX_LEVEL;
+    sortedList->level        = 0;
+    sortedList->seed         = 2463534242u;
+    sortedList->cmp          = cmp;
+
+    // Now bind the functions.
+    sortedList->insertSorted     = cd9sortedlist_insertSorted;
+    sortedList->insertSortedCopy = cd9sortedlist_insertSortedCopy;
+    sortedList->findSorted       = cd9sortedlist_findSorted;
+    sortedList->lowerBound       = cd9sortedlist_lowerBound;
+    sortedList->upperBound       = cd9sortedlist_upperBound;
+    sortedList->get              = cd9sortedlist_get;
+    sortedList->removeSorted     = cd9sortedlist_removeSorted;
+    sortedList->range            = cd9sortedlist_range;
+
+    return sortedList;
+}
+
+void cd9sortedlist_deleteList(CD9SortedList *sortedList)
+{
+    // Every tower takes part in the lowest lane, so it is enough to walk it.
+    CD9SkipNode *tower = sortedList->head->links[0].next;
+    CD9SkipNode *tmp;
+
+    while(tower != NULL) {
+        tmp = tower->links[0].next;
+        free(tower);
+        tower = tmp;
+    }
+
+    free(sortedList->head);
+    cd9list_deleteList(sortedList->list);
+    free(sortedList);
+}
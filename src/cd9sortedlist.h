@@ -0,0 +1,183 @@
+#ifndef CD9SORTEDLIST_H__
+#define CD9SORTEDLIST_H__
+
+#include <stdint.h>
+#include "cd9list.h"
+
+/**
+ * @brief The maximum number of express lanes a sorted list can have. With
+ *        a promotion probability of 1/4 this is enough for 4^16 elements.
+ */
+#define CD9SORTEDLIST_MAX_LEVEL 16
+
+struct CD9SkipNode;
+
+/**
+ * @brief A link of an express lane.
+ *
+ * @var CD9SkipLink::next The next tower on the same lane.
+ * @var CD9SkipLink::width The number of elements this link jumps over, it is
+ *      used to compute the index of an element without walking the list.
+ */
+typedef struct CD9SkipLink {
+    struct CD9SkipNode *next;
+    size_t width;
+} CD9SkipLink;
+
+/**
+ * @brief A tower built on top of a node of the underlying list. Only some of
+ *        the nodes have towers, the rest are reached by walking the list
+ *        from the closest tower.
+ *
+ * @var CD9SkipNode::node The node of the list this tower stands on.
+ * @var CD9SkipNode::height The number of lanes this tower takes part in.
+ * @var CD9SkipNode::links The links of the tower, one per lane.
+ */
+typedef struct CD9SkipNode {
+    CD9Node *node;
+    size_t height;
+    CD9SkipLink links[];
+} CD9SkipNode;
+
+/**
+ * @brief A list that keeps its elements ordered by the comparator it was
+ *        created with. The elements are stored in a regular \ref CD9List, so
+ *        you can iterate over `list` with `CD9FOREACH`, but you should never
+ *        modify it directly. On top of the list there is a skip list which
+ *        makes insertions and lookups run in O(log n).
+ *
+ * @var CD9SortedList::list The list that holds the elements in order.
+ * @var CD9SortedList::head The tower that starts every lane.
+ * @var CD9SortedList::level The number of lanes that are currently used.
+ * @var CD9SortedList::seed The state of the generator used to pick the
+ *      height of the towers.
+ * @var CD9SortedList::cmp The comparator that defines the order.
+ */
+typedef struct CD9SortedList {
+    CD9List *list;
+    CD9SkipNode *head;
+    size_t level;
+    uint32_t seed;
+    CD9CompareCallback cmp;
+
+    /**
+     * @brief Use this function to add an element to the list. The element
+     *        is placed after all the elements equal to it, so the insertion
+     *        order of equal elements is kept. Only the address is stored, see
+     *        \ref insertSortedCopy if you want to store a copy.
+     *
+     * @param self The current sorted list.
+     * @param data The data you want to insert.
+     *
+     * @return bool It returns `true` if the element was inserted and `false`
+     *         if malloc failed.
+     */
+    bool (*insertSorted)(void *self, const void *data);
+
+    /**
+     * @brief Similar to \ref insertSorted, but the list will store a copy of
+     *        the data.
+     *
+     * @param self The current sorted list.
+     * @param data The data you want to insert.
+     * @param size The size of the data you want to insert.
+     *
+     * @return bool It returns `true` if the element was inserted and `false`
+     *         if malloc failed.
+     */
+    bool (*insertSortedCopy)(void *self, const void *data, size_t size);
+
+    /**
+     * @brief Use this function to get the index of the first element equal
+     *        to `data`.
+     *
+     * @param self The current sorted list.
+     * @param data The data you are looking for.
+     *
+     * @return int The index of the element or `-1` if there is no such
+     *         element.
+     */
+    int (*findSorted)(void *self, const void *data);
+
+    /**
+     * @brief Use this function to get the index of the first element which
+     *        is not less than `data`.
+     *
+     * @param self The current sorted list.
+     * @param data The value used as bound.
+     *
+     * @return size_t The index of the element, or the length of the list if
+     *         all the elements are less than `data`.
+     */
+    size_t (*lowerBound)(void *self, const void *data);
+
+    /**
+     * @brief Use this function to get the index of the first element which
+     *        is bigger than `data`.
+     *
+     * @param self The current sorted list.
+     * @param data The value used as bound.
+     *
+     * @return size_t The index of the element, or the length of the list if
+     *         no element is bigger than `data`.
+     */
+    size_t (*upperBound)(void *self, const void *data);
+
+    /**
+     * @brief Use this function to get the data stored at `index`. Unlike
+     *        \ref CD9List::get it doesn't walk the whole list.
+     *
+     * @param self The current sorted list.
+     * @param index The index of the element.
+     *
+     * @return void * The data at that index or `NULL` if the index is not
+     *         valid.
+     */
+    void *(*get)(void *self, size_t index);
+
+    /**
+     * @brief Use this function to remove the first element equal to `data`.
+     *
+     * @param self The current sorted list.
+     * @param data The value you want to remove.
+     *
+     * @return int It returns `1` if an element was removed and `0`
+     *         otherwise.
+     */
+    int (*removeSorted)(void *self, const void *data);
+
+    /**
+     * @brief Use this function to get the elements between `low` and `high`,
+     *        both inclusive. Like \ref CD9List::slice, the result is a newly
+     *        allocated list that you have to delete.
+     *
+     * @param self The current sorted list.
+     * @param low The smallest value in the range.
+     * @param high The biggest value in the range.
+     *
+     * @return CD9List * A list with the elements in the range, in order, or
+     *         `NULL` if malloc failed.
+     */
+    CD9List *(*range)(void *self, const void *low, const void *high);
+} CD9SortedList;
+
+/**
+ * @brief Use this function to create a new sorted list.
+ *
+ * @param cmp The comparator that will define the order of the elements.
+ *
+ * @return CD9SortedList * A newly allocated sorted list.
+ */
+CD9SortedList *cd9sortedlist_createList(CD9CompareCallback cmp);
+
+/**
+ * @brief Use this function to free the memory allocated to a sorted list. It
+ *        will delete all its elements.
+ *
+ * @param sortedList The sorted list you want to delete.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9sortedlist_deleteList(CD9SortedList *sortedList);
+
+#endif // CD9SORTEDLIST_H__
@@ -0,0 +1,321 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "cd9list.h"
+#include "cd9serialize.h"
+#include "cd9stream.h"
+
+/**
+ * @brief The function run by the helper thread. It fills the buffers in
+ *        turns, waiting for the consumer to release a buffer before filling
+ *        it again. It stops at the end of the file.
+ */
+void *cd9stream_readAheadLoop(void *arg)
+{
+    CD9Stream *stream = arg;
+    int target        = 0;
+
+    for(;;) {
+        CD9StreamBuffer *buffer = &stream->buffers[target];
+
+        pthread_mutex_lock(&stream->lock);
+        while(buffer->ready && !stream->stop) {
+            pthread_cond_wait(&stream->changed, &stream->lock);
+        }
+
+        if(stream->stop) {
+            pthread_mutex_unlock(&stream->lock);
+            break;
+        }
+        pthread_mutex_unlock(&stream->lock);
+
+        // The consumer doesn't touch this buffer until it is ready, so the
+        // file can be read without holding the lock.
+        size_t filled = fread(buffer->data, 1, stream->bufferSize,
+                              stream->file);
+
+        pthread_mutex_lock(&stream->lock);
+        buffer->filled = filled;
+        buffer->ready  = true;
+        pthread_cond_broadcast(&stream->changed);
+        pthread_mutex_unlock(&stream->lock);
+
+        if(filled == 0) {
+            break;
+        }
+
+        target = 1 - target;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Helper function called when the current buffer was consumed. It
+ *        gives the buffer back to the helper thread and waits for the other
+ *        one, or it refills the buffer itself when there is no read ahead.
+ *
+ * @return bool It returns `false` at the end of the file.
+ */
+bool cd9stream_nextBuffer(CD9Stream *stream)
+{
+    // The helper thread stopped after the buffer that marks the end of the
+    // file, so there is nothing left to wait for.
+    if(stream->end) {
+        return false;
+    }
+
+    if(!stream->readAhead) {
+        CD9StreamBuffer *buffer = &stream->buffers[stream->current];
+
+        buffer->filled = fread(buffer->data, 1, stream->bufferSize,
+                               stream->file);
+        stream->offset = 0;
+        stream->end    = (buffer->filled == 0);
+
+        return !stream->end;
+    }
+
+    int next = 1 - stream->current;
+
+    pthread_mutex_lock(&stream->lock);
+    stream->buffers[stream->current].ready = false;
+    pthread_cond_broadcast(&stream->changed);
+
+    while(!stream->buffers[next].ready) {
+        pthread_cond_wait(&stream->changed, &stream->lock);
+    }
+    pthread_mutex_unlock(&stream->lock);
+
+    stream->current = next;
+    stream->offset  = 0;
+    stream->end     = (stream->buffers[next].filled == 0);
+
+    return !stream->end;
+}
+
+/**
+ * @brief Helper function that copies the next `size` bytes of the stream to
+ *        `out`, moving to the next buffers as needed.
+ */
+bool cd9stream_read(CD9Stream *stream, void *out, size_t size)
+{
+    unsigned char *destination = out;
+
+    while(size > 0) {
+        CD9StreamBuffer *buffer = &stream->buffers[stream->current];
+
+        if(stream->offset == buffer->filled) {
+            if(!cd9stream_nextBuffer(stream)) {
+                return false;
+            }
+            continue;
+        }
+
+        size_t available = buffer->filled - stream->offset;
+        size_t chunk     = (available < size) ? available : size;
+
+        memcpy(destination, buffer->data + stream->offset, chunk);
+        stream->offset += chunk;
+        destination    += chunk;
+        size           -= chunk;
+    }
+
+    return true;
+}
+
+bool cd9stream_next(CD9Stream *stream, void **value, size_t *size)
+{
+    if(stream->index == stream->length) {
+        return false;
+    }
+
+    unsigned char byte;
+    size_t shift = 0;
+
+    *size = 0;
+
+    do {
+        if(shift >= 64 || !cd9stream_read(stream, &byte, 1)) {
+            return false;
+        }
+
+        *size |= (size_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while(byte & 0x80);
+
+    // Every element has at least one byte, and they can't hold more bytes
+    // than the header says.
+    if(*size == 0 || *size > stream->bytes) {
+        return false;
+    }
+
+    // The elements follow their sizes in the buffers, so they are not
+    // aligned. They are copied to the scratch buffer, which is aligned like
+    // the memory returned by malloc. The header can't be checked against the
+    // size of the file, so the buffer grows with the bytes that actually
+    // arrive, see \ref CD9SERIALIZE_MAX_BLOCK_SIZE.
+    for(size_t done = 0; done < *size;) {
+        size_t chunk = *size - done;
+
+        if(chunk > CD9SERIALIZE_MAX_BLOCK_SIZE) {
+            chunk = CD9SERIALIZE_MAX_BLOCK_SIZE;
+        }
+
+        if(stream->scratchSize < done + chunk) {
+            unsigned char *scratch = realloc(stream->scratch, done + chunk);
+            if(scratch == NULL) { // Malloc failed.
+                return false;
+            }
+
+            stream->scratch     = scratch;
+            stream->scratchSize = done + chunk;
+        }
+
+        if(!cd9stream_read(stream, stream->scratch + done, chunk)) {
+            return false;
+        }
+
+        done += chunk;
+    }
+
+    *value = stream->scratch;
+
+    stream->bytes -= *size;
+    stream->index++;
+
+    return true;
+}
+
+CD9Stream *cd9stream_open(FILE *file, size_t bufferSize, bool readAhead)
+{
+    CD9Stream *stream = calloc(1, sizeof(CD9Stream));
+    if(stream == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    stream->file       = file;
+    stream->bufferSize = (bufferSize != 0) ? bufferSize :
+                         CD9STREAM_DEFAULT_BUFFER_SIZE;
+    stream->readAhead  = readAhead;
+
+    // Start as if the second buffer was consumed, so the first read moves
+    // to the first buffer. The helper thread must not fill the second
+    // buffer before the consumer gives it back.
+    stream->current          = 1;
+    stream->offset           = 0;
+    stream->buffers[1].ready = true;
+
+    for(int i = 0; i < 2; i++) {
+        stream->buffers[i].data = malloc(stream->bufferSize);
+        if(stream->buffers[i].data == NULL) {
+            free(stream->buffers[0].data);
+            free(stream);
+
+            return NULL;
+        }
+    }
+
+    if(readAhead) {
+        pthread_mutex_init(&stream->lock, NULL);
+        pthread_cond_init(&stream->changed, NULL);
+
+        if(pthread_create(&stream->thread, NULL, cd9stream_readAheadLoop,
+                          stream) != 0) {
+            // We can still read the file, just not ahead.
+            pthread_mutex_destroy(&stream->lock);
+            pthread_cond_destroy(&stream->changed);
+            stream->readAhead = false;
+        }
+    }
+
+    unsigned char header[CD9SERIALIZE_HEADER_SIZE];
+
+    if(!cd9stream_read(stream, header, CD9SERIALIZE_HEADER_SIZE) ||
+       !cd9serialize_decodeHeader(header, &stream->length, &stream->bytes)) {
+        cd9stream_close(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+void cd9stream_close(CD9Stream *stream)
+{
+    if(stream->readAhead) {
+        pthread_mutex_lock(&stream->lock);
+        stream->stop = true;
+        pthread_cond_broadcast(&stream->changed);
+        pthread_mutex_unlock(&stream->lock);
+
+        pthread_join(stream->thread, NULL);
+        pthread_mutex_destroy(&stream->lock);
+        pthread_cond_destroy(&stream->changed);
+    }
+
+    free(stream->buffers[0].data);
+    free(stream->buffers[1].data);
+    free(stream->scratch);
+    free(stream);
+}
+
+int cd9stream_find(CD9Stream *stream, const void *data, CD9FindCallback cmp)
+{
+    CD9STREAM_FOREACH(stream, value, size) {
+        if(cmp(value, data, size)) {
+            return stream->index - 1;
+        }
+    }
+
+    return -1;
+}
+
+CD9List *cd9stream_filter(CD9Stream       *stream,
+                          const void      *data,
+                          CD9FindCallback cmp)
+{
+    CD9List *filtered = cd9list_createList();
+    CD9Node *tail     = NULL;
+
+    if(filtered == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    CD9STREAM_FOREACH(stream, value, size) {
+        if(cmp(value, data, size)) {
+            continue;
+        }
+
+        // Keep the tail, the result may be big as well.
+        CD9Node *node = cd9list_createListNode(filtered, value, size);
+        if(node == NULL) { // Malloc failed.
+            cd9list_deleteList(filtered);
+            return NULL;
+        }
+
+        if(tail == NULL) {
+            filtered->nodes = node;
+        }
+        else {
+            tail->next = node;
+        }
+
+        tail = node;
+        filtered->length++;
+    }
+
+    return filtered;
+}
+
+void cd9stream_reduce(CD9Stream         *stream,
+                      CD9ReduceCallback func,
+                      void              *accumulator)
+{
+    CD9STREAM_FOREACH(stream, value, size) {
+        func(accumulator, value, size);
+    }
+}
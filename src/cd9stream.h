@@ -0,0 +1,177 @@
+#ifndef CD9STREAM_H__
+#define CD9STREAM_H__
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "cd9list.h"
+
+/**
+ * @brief The size of each of the 2 buffers of a stream when the user
+ *        doesn't specify one.
+ */
+#define CD9STREAM_DEFAULT_BUFFER_SIZE (256 * 1024)
+
+/**
+ * @brief This is the callback passed to `cd9stream_reduce`. It is called on
+ *        every element of the stream.
+ *
+ * @param accumulator The value passed to `cd9stream_reduce`, the callback
+ *        is expected to update it.
+ * @param item The data of an element.
+ * @param size The size of `item`.
+ *
+ * @return void It doesn't return anything.
+ */
+typedef void (*CD9ReduceCallback)(void       *accumulator,
+                                  const void *item,
+                                  size_t     size);
+
+/**
+ * @brief One of the 2 buffers of a stream.
+ *
+ * @var CD9StreamBuffer::data The bytes read from the file.
+ * @var CD9StreamBuffer::filled The number of bytes in `data`, `0` means that
+ *      the end of the file was reached.
+ * @var CD9StreamBuffer::ready It is `true` while the buffer holds bytes that
+ *      were not consumed yet.
+ */
+typedef struct CD9StreamBuffer {
+    unsigned char *data;
+    size_t filled;
+    bool ready;
+} CD9StreamBuffer;
+
+/**
+ * @brief A reader that walks the elements of a file written by
+ *        `cd9list_serialize` without building the list, so the file can be
+ *        bigger than the memory. Only the 2 buffers of the stream are kept
+ *        in memory. With read ahead, a helper thread fills one buffer while
+ *        the elements of the other one are consumed.
+ *
+ * @var CD9Stream::file The file the elements are read from.
+ * @var CD9Stream::length The number of elements in the file.
+ * @var CD9Stream::bytes The number of bytes of the elements that were not
+ *      read yet, as told by the header of the file.
+ * @var CD9Stream::index The index of the next element.
+ * @var CD9Stream::buffers The 2 buffers.
+ * @var CD9Stream::bufferSize The size of each buffer.
+ * @var CD9Stream::current The buffer that is consumed.
+ * @var CD9Stream::offset The position of the next byte in the current buffer.
+ * @var CD9Stream::scratch Holds the current element, aligned like the memory
+ *      returned by malloc.
+ * @var CD9Stream::scratchSize The size of `scratch`.
+ * @var CD9Stream::readAhead It is `true` if the buffers are filled by the
+ *      helper thread.
+ * @var CD9Stream::end It is `true` once the end of the file was reached.
+ * @var CD9Stream::stop Tells the helper thread to stop.
+ */
+typedef struct CD9Stream {
+    FILE *file;
+    size_t length;
+    size_t bytes;
+    size_t index;
+    CD9StreamBuffer buffers[2];
+    size_t bufferSize;
+    int current;
+    size_t offset;
+    unsigned char *scratch;
+    size_t scratchSize;
+    bool readAhead;
+    bool end;
+    bool stop;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} CD9Stream;
+
+/**
+ * @brief Use this macro to iterate over the elements of a stream. At every
+ *        iteration `value` is a `void *` pointer to the data of an element
+ *        and `size` is its size. `value` is aligned like the memory returned
+ *        by malloc, so it can be cast to a pointer to the type that was
+ *        serialized, and it is valid only until the next iteration.
+ */
+#define CD9STREAM_FOREACH(stream, value, size) \
+    for(size_t size = 0, stopS1 = 1; stopS1 != 0; stopS1 = 0) \
+        for(void *value = NULL; cd9stream_next(stream, &value, &size);)
+
+/**
+ * @brief Use this function to start reading a serialized list. The file
+ *        should be positioned at the beginning of the list, it is not
+ *        closed by `cd9stream_close`.
+ *
+ * @param file The file, opened for reading in binary mode.
+ * @param bufferSize The size of each of the 2 buffers, `0` for the default.
+ * @param readAhead If it is `true` a helper thread will read the file
+ *        ahead of the consumer.
+ *
+ * @return CD9Stream * The stream or `NULL` if the file doesn't start with a
+ *         valid header.
+ */
+CD9Stream *cd9stream_open(FILE *file, size_t bufferSize, bool readAhead);
+
+/**
+ * @brief Use this function to stop reading and free the stream.
+ *
+ * @param stream The stream.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9stream_close(CD9Stream *stream);
+
+/**
+ * @brief Use this function to get the next element of the stream.
+ *
+ * @param stream The stream.
+ * @param value Filled with a pointer to a copy of the data of the element,
+ *        aligned like the memory returned by malloc. It is valid only until
+ *        the next call.
+ * @param size Filled with the size of the element.
+ *
+ * @return bool It returns `false` when there are no more elements, the file
+ *         is truncated or corrupted or malloc failed.
+ */
+bool cd9stream_next(CD9Stream *stream, void **value, size_t *size);
+
+/**
+ * @brief Similar to \ref CD9List::find, but it consumes the stream until
+ *        the first match.
+ *
+ * @param stream The stream.
+ * @param data The data you are looking for.
+ * @param cmp The comparator.
+ *
+ * @return int The index of the element or `-1` if there is no match.
+ */
+int cd9stream_find(CD9Stream *stream, const void *data, CD9FindCallback cmp);
+
+/**
+ * @brief Similar to \ref CD9List::filter, it consumes the whole stream and
+ *        only the elements that are kept are copied in the result.
+ *
+ * @param stream The stream.
+ * @param data This data will be passed to `cmp` at every call.
+ * @param cmp The elements for which it returns `true` are filtered out.
+ *
+ * @return CD9List * The list of the elements that were kept or `NULL` if
+ *         malloc failed.
+ */
+CD9List *cd9stream_filter(CD9Stream       *stream,
+                          const void      *data,
+                          CD9FindCallback cmp);
+
+/**
+ * @brief Use this function to call `func` on every element of the stream.
+ *
+ * @param stream The stream.
+ * @param func The callback.
+ * @param accumulator This value will be passed to `func` at every call.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9stream_reduce(CD9Stream         *stream,
+                      CD9ReduceCallback func,
+                      void              *accumulator);
+
+#endif // CD9STREAM_H__
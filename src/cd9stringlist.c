@@ -0,0 +1,576 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "cd9list.h"
+#include "cd9arena.h"
+#include "cd9stringlist.h"
+
+/**
+ * @brief Helper function that hashes a string. A size of `0` would make
+ *        `cd9list_defaultHash` hash the address, but the empty strings are
+ *        all equal.
+ */
+size_t cd9stringlist_hash(const char *string, size_t length)
+{
+    return (length != 0) ? cd9list_defaultHash(string, length) : 0;
+}
+
+/**
+ * @brief Helper function that tells if 2 strings are equal. The bytes are
+ *        only compared when the hashes and the lengths are equal.
+ */
+bool cd9stringlist_equal(const CD9String *a, const CD9String *b)
+{
+    return a->hash == b->hash && a->length == b->length &&
+           (a->data == b->data || !memcmp(a->data, b->data, a->length));
+}
+
+/**
+ * @brief Helper function that allocates an empty hash table with room for
+ *        `count` strings.
+ *
+ * @param count The number of strings the table will hold.
+ * @param mask Filled with the number of slots minus `1`.
+ *
+ * @return CD9String * The table or `NULL` if malloc failed.
+ */
+CD9String *cd9stringlist_createTable(size_t count, size_t *mask)
+{
+    size_t capacity = 16;
+
+    // The table is kept at most half full, so the probes stay short.
+    while(capacity < 2 * count) {
+        capacity *= 2;
+    }
+
+    *mask = capacity - 1;
+
+    return calloc(capacity, sizeof(CD9String));
+}
+
+/**
+ * @brief Helper function that looks for a string in a hash table.
+ *
+ * @return CD9String * The slot that holds the string or the empty slot where
+ *         it should be stored.
+ */
+CD9String *cd9stringlist_lookup(CD9String       *table,
+                                size_t          mask,
+                                const CD9String *key)
+{
+    size_t i = key->hash & mask;
+
+    while(table[i].data != NULL && !cd9stringlist_equal(&table[i], key)) {
+        i = (i + 1) & mask;
+    }
+
+    return &table[i];
+}
+
+/**
+ * @brief Helper function that makes room for one more string in the table
+ *        of the interned strings.
+ *
+ * @return int It returns `1` on success and `0` if malloc failed.
+ */
+int cd9stringlist_reserveInterned(CD9StringList *list)
+{
+    if(2 * (list->internedCount + 1) <= list->internedMask + 1) {
+        return 1;
+    }
+
+    size_t mask;
+    CD9String *table = cd9stringlist_createTable(list->internedMask + 1,
+                                                 &mask);
+
+    if(table == NULL) { // Malloc failed.
+        return 0;
+    }
+
+    for(size_t i = 0; i <= list->internedMask; i++) {
+        if(list->interned[i].data != NULL) {
+            *cd9stringlist_lookup(table, mask, &list->interned[i]) =
+                list->interned[i];
+        }
+    }
+
+    free(list->interned);
+    list->interned     = table;
+    list->internedMask = mask;
+
+    return 1;
+}
+
+/**
+ * @brief Helper function that copies a string in the arena of the list. The
+ *        short strings are packed in the current chunk.
+ *
+ * @return const char * The copy or `NULL` if malloc failed.
+ */
+const char *cd9stringlist_store(CD9StringList *list,
+                                const char    *string,
+                                size_t        length)
+{
+    size_t size = length + 1;
+    char *copy;
+
+    // A long string would waste most of a chunk, it gets its own memory.
+    if(size > CD9STRINGLIST_CHUNK_SIZE / 4) {
+        copy = cd9arena_alloc(list->arena, size);
+    }
+    else {
+        if(size > list->chunkLeft) {
+            char *chunk = cd9arena_alloc(list->arena,
+                                         CD9STRINGLIST_CHUNK_SIZE);
+
+            if(chunk == NULL) { // Malloc failed.
+                return NULL;
+            }
+
+            list->chunk     = chunk;
+            list->chunkLeft = CD9STRINGLIST_CHUNK_SIZE;
+        }
+
+        copy             = list->chunk;
+        list->chunk     += size;
+        list->chunkLeft -= size;
+    }
+
+    if(copy == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+
+    return copy;
+}
+
+/**
+ * @brief Helper function that appends a string that is already stored in
+ *        the arena.
+ *
+ * @return int It returns `1` on success and `0` if malloc failed.
+ */
+int cd9stringlist_push(CD9StringList *list, const CD9String *string)
+{
+    if(list->length == list->capacity) {
+        size_t capacity    = (list->capacity == 0) ? 16 :
+                             list->capacity * 2;
+        CD9String *strings = realloc(list->strings,
+                                     capacity * sizeof(CD9String));
+
+        if(strings == NULL) { // Malloc failed.
+            return 0;
+        }
+
+        list->strings  = strings;
+        list->capacity = capacity;
+    }
+
+    list->strings[list->length++] = *string;
+
+    return 1;
+}
+
+/**
+ * @brief Helper function that looks for a string in the table of the
+ *        interned strings, after making room for it.
+ *
+ * @return CD9String * The slot that holds the string, the empty slot where
+ *         it should be stored or `NULL` if malloc failed.
+ */
+CD9String *cd9stringlist_internSlot(CD9StringList   *list,
+                                    const CD9String *key)
+{
+    if(!cd9stringlist_reserveInterned(list)) {
+        return NULL;
+    }
+
+    return cd9stringlist_lookup(list->interned, list->internedMask, key);
+}
+
+int cd9stringlist_appendLength(void *self, const char *string, size_t length)
+{
+    CD9StringList *list = (CD9StringList *)self;
+    CD9String *slot     = NULL;
+    CD9String item      = {
+        string, length, cd9stringlist_hash(string, length)
+    };
+
+    // An interned string is not copied again.
+    if(list->interned != NULL) {
+        slot = cd9stringlist_internSlot(list, &item);
+
+        if(slot == NULL) {
+            return 0;
+        }
+
+        if(slot->data != NULL) {
+            return cd9stringlist_push(list, slot);
+        }
+    }
+
+    item.data = cd9stringlist_store(list, string, length);
+
+    if(item.data == NULL || !cd9stringlist_push(list, &item)) {
+        return 0;
+    }
+
+    if(slot != NULL) {
+        *slot = item;
+        list->internedCount++;
+    }
+
+    return 1;
+}
+
+int cd9stringlist_append(void *self, const char *string)
+{
+    return cd9stringlist_appendLength(self, string, strlen(string));
+}
+
+const char *cd9stringlist_get(void *self, size_t index)
+{
+    CD9StringList *list = (CD9StringList *)self;
+
+    if(index >= list->length) {
+        return NULL;
+    }
+
+    return list->strings[index].data;
+}
+
+int cd9stringlist_find(void *self, const char *string)
+{
+    CD9StringList *list = (CD9StringList *)self;
+    size_t length       = strlen(string);
+    CD9String key       = {
+        string, length, cd9stringlist_hash(string, length)
+    };
+
+    if(list->interned != NULL) {
+        CD9String *slot = cd9stringlist_lookup(list->interned,
+                                               list->internedMask, &key);
+
+        if(slot->data == NULL) {
+            return -1;
+        }
+
+        // Every occurrence of the string shares its bytes, so the addresses
+        // are enough.
+        for(size_t i = 0; i < list->length; i++) {
+            if(list->strings[i].data == slot->data) {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    for(size_t i = 0; i < list->length; i++) {
+        if(cd9stringlist_equal(&list->strings[i], &key)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Helper function used by `sort` in order to compare 2 strings in
+ *        the order of `strcmp`.
+ */
+int cd9stringlist_compare(const void *a, const void *b)
+{
+    const CD9String *string1 = a;
+    const CD9String *string2 = b;
+    size_t length            = (string1->length < string2->length) ?
+                               string1->length : string2->length;
+
+    int result = (string1->data == string2->data) ? 0 :
+                 memcmp(string1->data, string2->data, length);
+
+    if(result != 0) {
+        return result;
+    }
+
+    return (string1->length > string2->length) -
+           (string1->length < string2->length);
+}
+
+/**
+ * @brief An element of the array sorted by `sort`. Most comparisons are
+ *        decided by the first bytes of the strings, so they are kept next
+ *        to the index and the strings themselves are only read on a tie.
+ *
+ * @var CD9StringKey::prefix The first 8 bytes of the string, the first one
+ *      is the most significant, so the prefixes are ordered like the
+ *      strings. The shorter strings are padded with `0`.
+ * @var CD9StringKey::index The index of the string in the list.
+ */
+typedef struct CD9StringKey {
+    uint64_t prefix;
+    size_t index;
+} CD9StringKey;
+
+/**
+ * @brief Helper function that compares 2 keys of `sort`.
+ */
+int cd9stringlist_compareKeys(const CD9StringList *list,
+                              const CD9StringKey  *a,
+                              const CD9StringKey  *b)
+{
+    if(a->prefix != b->prefix) {
+        return (a->prefix < b->prefix) ? -1 : 1;
+    }
+
+    return cd9stringlist_compare(&list->strings[a->index],
+                                 &list->strings[b->index]);
+}
+
+void cd9stringlist_sort(void *self)
+{
+    CD9StringList *list = (CD9StringList *)self;
+    size_t length       = list->length;
+
+    if(length < 2) {
+        return;
+    }
+
+    CD9StringKey *keys = malloc(2 * length * sizeof(CD9StringKey));
+
+    if(keys == NULL) { // Malloc failed.
+        // qsort doesn't need our memory, it is just slower.
+        qsort(list->strings, length, sizeof(CD9String),
+              cd9stringlist_compare);
+        return;
+    }
+
+    for(size_t i = 0; i < length; i++) {
+        const CD9String *string = &list->strings[i];
+        uint64_t prefix         = 0;
+
+        for(size_t j = 0; j < sizeof(uint64_t); j++) {
+            unsigned char byte = (j < string->length) ?
+                                 (unsigned char)string->data[j] : 0;
+
+            prefix = (prefix << 8) | byte;
+        }
+
+        keys[i].prefix = prefix;
+        keys[i].index  = i;
+    }
+
+    // A bottom up merge sort, the runs go back and forth between the 2
+    // halves of `keys`. Taking the left key on a tie keeps the sort stable.
+    CD9StringKey *from = keys;
+    CD9StringKey *to   = keys + length;
+
+    for(size_t width = 1; width < length; width *= 2) {
+        for(size_t low = 0; low < length; low += 2 * width) {
+            size_t middle = (low + width < length) ? low + width : length;
+            size_t high   = (middle + width < length) ? middle + width :
+                                                        length;
+            size_t i      = low;
+            size_t j      = middle;
+            size_t k      = low;
+
+            while(i < middle && j < high) {
+                if(cd9stringlist_compareKeys(list, &from[j], &from[i]) < 0) {
+                    to[k++] = from[j++];
+                }
+                else {
+                    to[k++] = from[i++];
+                }
+            }
+
+            while(i < middle) {
+                to[k++] = from[i++];
+            }
+
+            while(j < high) {
+                to[k++] = from[j++];
+            }
+        }
+
+        CD9StringKey *tmp = from;
+        from              = to;
+        to                = tmp;
+    }
+
+    // The strings are moved in place, one cycle of the permutation at a
+    // time. A key whose index is its own position is done.
+    for(size_t i = 0; i < length; i++) {
+        if(from[i].index == i) {
+            continue;
+        }
+
+        CD9String first = list->strings[i];
+        size_t j        = i;
+
+        while(from[j].index != i) {
+            size_t next      = from[j].index;
+            list->strings[j] = list->strings[next];
+            from[j].index    = j;
+            j                = next;
+        }
+
+        list->strings[j] = first;
+        from[j].index    = j;
+    }
+
+    free(keys);
+}
+
+size_t cd9stringlist_unique(void *self)
+{
+    CD9StringList *list = (CD9StringList *)self;
+    size_t kept         = 0;
+    size_t mask;
+    CD9String *seen     = cd9stringlist_createTable(list->length, &mask);
+
+    if(seen == NULL) { // Malloc failed.
+        return 0;
+    }
+
+    for(size_t i = 0; i < list->length; i++) {
+        CD9String *slot = cd9stringlist_lookup(seen, mask,
+                                               &list->strings[i]);
+
+        if(slot->data != NULL) {
+            continue;
+        }
+
+        *slot                 = list->strings[i];
+        list->strings[kept++] = list->strings[i];
+    }
+
+    free(seen);
+
+    size_t removed = list->length - kept;
+    list->length   = kept;
+
+    return removed;
+}
+
+CD9StringList *cd9stringlist_filterBySet(void                *self,
+                                         const CD9StringList *set)
+{
+    CD9StringList *list     = (CD9StringList *)self;
+    CD9StringList *filtered = cd9stringlist_createListOnArena(
+        list->arena, list->interned != NULL);
+    size_t mask;
+    CD9String *table        = cd9stringlist_createTable(set->length, &mask);
+
+    if(filtered == NULL || table == NULL) { // Malloc failed.
+        if(filtered != NULL) {
+            cd9stringlist_deleteList(filtered);
+        }
+        free(table);
+
+        return NULL;
+    }
+
+    for(size_t i = 0; i < set->length; i++) {
+        CD9String *slot = cd9stringlist_lookup(table, mask,
+                                               &set->strings[i]);
+
+        if(slot->data == NULL) {
+            *slot = set->strings[i];
+        }
+    }
+
+    for(size_t i = 0; i < list->length; i++) {
+        CD9String *string = &list->strings[i];
+
+        if(cd9stringlist_lookup(table, mask, string)->data != NULL) {
+            continue;
+        }
+
+        if(filtered->interned != NULL) {
+            CD9String *slot = cd9stringlist_internSlot(filtered, string);
+
+            if(slot != NULL && slot->data == NULL) {
+                *slot = *string;
+                filtered->internedCount++;
+            }
+
+            string = slot;
+        }
+
+        if(string == NULL || !cd9stringlist_push(filtered, string)) {
+            cd9stringlist_deleteList(filtered);
+            filtered = NULL;
+            break;
+        }
+    }
+
+    free(table);
+
+    return filtered;
+}
+
+CD9StringList *cd9stringlist_createListOnArena(CD9Arena *arena,
+                                               bool     interning)
+{
+    CD9StringList *list = malloc(sizeof(CD9StringList));
+    if(list == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    list->strings       = NULL;
+    list->length        = 0;
+    list->capacity      = 0;
+    list->arena         = cd9arena_retain(arena);
+    list->chunk         = NULL;
+    list->chunkLeft     = 0;
+    list->interned      = NULL;
+    list->internedCount = 0;
+    list->internedMask  = 0;
+
+    if(interning) {
+        list->interned = cd9stringlist_createTable(0, &list->internedMask);
+
+        if(list->interned == NULL) { // Malloc failed.
+            cd9arena_release(list->arena);
+            free(list);
+            return NULL;
+        }
+    }
+
+    // Now bind the functions.
+    list->append       = cd9stringlist_append;
+    list->appendLength = cd9stringlist_appendLength;
+    list->get          = cd9stringlist_get;
+    list->find         = cd9stringlist_find;
+    list->sort         = cd9stringlist_sort;
+    list->unique       = cd9stringlist_unique;
+    list->filterBySet  = cd9stringlist_filterBySet;
+
+    return list;
+}
+
+CD9StringList *cd9stringlist_createList(bool interning)
+{
+    CD9Arena *arena = cd9arena_create(0);
+    if(arena == NULL) { // Malloc failed.
+        return NULL;
+    }
+
+    CD9StringList *list = cd9stringlist_createListOnArena(arena, interning);
+
+    // The list holds its own reference.
+    cd9arena_release(arena);
+
+    return list;
+}
+
+void cd9stringlist_deleteList(CD9StringList *list)
+{
+    free(list->strings);
+    free(list->interned);
+    cd9arena_release(list->arena);
+    free(list);
+}
@@ -0,0 +1,183 @@
+#ifndef CD9STRINGLIST_H__
+#define CD9STRINGLIST_H__
+
+#include <stdbool.h>
+#include "cd9list.h"
+#include "cd9arena.h"
+
+/**
+ * @brief The size of the chunks a string list takes from its arena. The
+ *        strings are packed back to back in a chunk, the longer strings get
+ *        an allocation of their own.
+ */
+#define CD9STRINGLIST_CHUNK_SIZE (16 * 1024)
+
+/**
+ * @brief An element of a string list.
+ *
+ * @var CD9String::data The string, it is always followed by a `'\0'`.
+ * @var CD9String::length The number of bytes of the string, without the
+ *      `'\0'`.
+ * @var CD9String::hash The hash of the string, see `cd9list_defaultHash`.
+ */
+typedef struct CD9String {
+    const char *data;
+    size_t length;
+    size_t hash;
+} CD9String;
+
+/**
+ * @brief A list of strings. Unlike a \ref CD9List of copies, which takes 2
+ *        mallocs per string, the elements are kept in an array and the
+ *        strings are packed in an arena that is released with the list. The
+ *        length and the hash of every string are computed once, when it is
+ *        added, so the strings are compared with `memcmp` only when their
+ *        hashes and their lengths are equal.
+ *
+ *        When interning is on, equal strings share the same bytes, so a
+ *        string is stored once no matter how many times it is appended and
+ *        a string that was never added is found missing without walking the
+ *        list. The bytes of the removed strings are only given back when the
+ *        list is deleted.
+ *
+ * @var CD9StringList::strings The elements, in the order of the list.
+ * @var CD9StringList::length The number of elements.
+ * @var CD9StringList::capacity The number of elements `strings` can hold.
+ * @var CD9StringList::arena The arena the strings are stored in. It can be
+ *      shared with the lists built by `filterBySet`.
+ * @var CD9StringList::chunk The free part of the chunk the next strings are
+ *      packed in.
+ * @var CD9StringList::chunkLeft The number of free bytes of `chunk`.
+ * @var CD9StringList::interned The table of the stored strings, an open
+ *      addressing hash table, or `NULL` if interning is off.
+ * @var CD9StringList::internedCount The number of strings in `interned`.
+ * @var CD9StringList::internedMask The number of slots of `interned` minus
+ *      `1`.
+ */
+typedef struct CD9StringList {
+    CD9String *strings;
+    size_t length;
+    size_t capacity;
+    CD9Arena *arena;
+    char *chunk;
+    size_t chunkLeft;
+    CD9String *interned;
+    size_t internedCount;
+    size_t internedMask;
+
+    /**
+     * @brief Use this function to append a copy of a string at the end of
+     *        the list.
+     *
+     * @param self The current list.
+     * @param string The string, it must end with a `'\0'`.
+     *
+     * @return int It returns `1` if the string was appended and `0` if
+     *         malloc failed.
+     */
+    int (*append)(void *self, const char *string);
+
+    /**
+     * @brief Similar to \ref append, but the string doesn't have to end with
+     *        a `'\0'`, for example a token that points in a bigger text.
+     *
+     * @param self The current list.
+     * @param string The string.
+     * @param length The number of bytes of the string.
+     *
+     * @return int It returns `1` if the string was appended and `0` if
+     *         malloc failed.
+     */
+    int (*appendLength)(void *self, const char *string, size_t length);
+
+    /**
+     * @brief Use this function to get a string, its length is stored in
+     *        \ref strings.
+     *
+     * @param self The current list.
+     * @param index The index of the string.
+     *
+     * @return const char * The string or `NULL` if the index is out of
+     *         bounds.
+     */
+    const char *(*get)(void *self, size_t index);
+
+    /**
+     * @brief Use this function to find the first occurrence of a string.
+     *
+     * @param self The current list.
+     * @param string The string, it must end with a `'\0'`.
+     *
+     * @return int The index of the string or `-1` if it is not in the list.
+     */
+    int (*find)(void *self, const char *string);
+
+    /**
+     * @brief Use this function to sort the list in the byte order of the
+     *        strings, the order of `strcmp`.
+     *
+     * @param self The current list.
+     *
+     * @return void It doesn't return anything.
+     */
+    void (*sort)(void *self);
+
+    /**
+     * @brief Use this function to remove the strings that appear earlier in
+     *        the list, so only the first occurrence of every string is kept.
+     *
+     * @param self The current list.
+     *
+     * @return size_t The number of strings removed. It is `0` if malloc
+     *         failed, the list is not changed in that case.
+     */
+    size_t (*unique)(void *self);
+
+    /**
+     * @brief Similar to \ref CD9List::filterBySet, the strings found in
+     *        `set` are dropped. The new list shares the arena of the list,
+     *        so the strings are not copied.
+     *
+     * @param self The current list.
+     * @param set The strings that are dropped.
+     *
+     * @return CD9StringList * The filtered list or `NULL` if malloc failed.
+     */
+    struct CD9StringList *(*filterBySet)(void                       *self,
+                                         const struct CD9StringList *set);
+} CD9StringList;
+
+/**
+ * @brief Use this function to create a new string list.
+ *
+ * @param interning `true` if equal strings should share their bytes.
+ *
+ * @return CD9StringList * The list or `NULL` if malloc failed.
+ */
+CD9StringList *cd9stringlist_createList(bool interning);
+
+/**
+ * @brief Use this function to create a string list that packs its strings
+ *        in `arena`, see `cd9list_createListOnArena`. The list takes its own
+ *        reference to the arena.
+ *
+ * @param arena The arena, see `cd9arena_create`.
+ * @param interning `true` if equal strings should share their bytes.
+ *
+ * @return CD9StringList * The list or `NULL` if malloc failed.
+ */
+CD9StringList *cd9stringlist_createListOnArena(CD9Arena *arena,
+                                               bool     interning);
+
+/**
+ * @brief Use this function to free a string list and its strings. The arena
+ *        is released, so the strings stay valid as long as a list built by
+ *        `filterBySet` uses them.
+ *
+ * @param list The list.
+ *
+ * @return void It doesn't return anything.
+ */
+void cd9stringlist_deleteList(CD9StringList *list);
+
+#endif // CD9STRINGLIST_H__
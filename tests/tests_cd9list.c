@@ -2,7 +2,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <cd9/cd9list.h>
+#include <cd9/cd9sortedlist.h>
+#include <cd9/cd9serialize.h>
+#include <cd9/cd9persistentlist.h>
+#include <cd9/cd9stream.h>
+#include <cd9/cd9simd.h>
+#include <cd9/cd9query.h>
+#include <cd9/cd9stringlist.h>
 #include "minunit.h"
 
 int tests_run = 0;
@@ -17,7 +25,7 @@ static char *test_createNode()
         (char *)node->data == data );
     mu_assert("[test_createNode] Next node is not NULL", node->next == NULL);
 
-    cd9list_deleteNode(node);
+    cd9list_deleteNode(NULL, node);
 
     return 0;
 }
@@ -57,7 +65,7 @@ static char *test_getNode()
     mu_assert("[test_getNode] Node data is wrong", 
               node->data == queryNode->data);
 
-    cd9list_deleteNode(node);
+    cd9list_deleteNode(NULL, node);
     cd9list_deleteList(list);
 
     return 0;
@@ -269,9 +277,9 @@ static char *test_copyNodeData()
 {
     const char *data = "foo";
     CD9Node *node    = cd9list_createNode(data, 4);
-    void *copy       = cd9list_copyNodeData(node);
+    void *copy       = cd9list_copyNodeData(NULL, node);
 
-    cd9list_deleteNode(node);
+    cd9list_deleteNode(NULL, node);
 
     mu_assert("[test_copyNodeData] The node data was not copied properly", 
               !strcmp(copy, data));
@@ -358,6 +366,9 @@ static char *test_insert()
               (char *)list->get(list, 2) == toInsert[1]);
     mu_assert("[test_insert] toInsert[2] was not inserted properly", 
               (char *)list->get(list, list->length - 1) == toInsert[2]);
+    mu_assert("[test_insert] An invalid index was accepted",
+              list->insert(list, list->length + 1, toInsert[0]) == 0 &&
+              list->length == 6);
 
     cd9list_deleteList(list);
 
@@ -589,6 +600,10 @@ static char *test_slice()
     }
 
     cd9list_deleteList(twoByTwo);
+
+    mu_assert("[test_slice] A step of 0 gave a slice",
+              list->slice(list, 0, 0, 0) == NULL);
+
     cd9list_deleteList(list);
 
     return 0;
@@ -756,6 +771,2090 @@ static char *test_filterBySet()
     return 0;
 }
 
+static char *test_sortedList()
+{
+    int values[200];
+    CD9SortedList *sortedList = cd9sortedlist_createList(test_sort_int_cmp);
+
+    for(int i = 0; i < 200; i++) {
+        values[i] = (i * 37) % 50; // Every value appears 4 times.
+        mu_assert("[test_sortedList] The element was not inserted",
+                  sortedList->insertSortedCopy(sortedList, &values[i],
+                                               sizeof(int)));
+    }
+
+    mu_assert("[test_sortedList] The length was not set properly",
+              sortedList->list->length == 200);
+
+    CD9FOREACH(sortedList->list, value, index) {
+        mu_assert("[test_sortedList] The elements are not in order",
+                  *(int *)value == (int)index / 4);
+        mu_assert("[test_sortedList] Get returned the wrong element",
+                  sortedList->get(sortedList, index) == value);
+    }
+
+    int key = 10;
+    mu_assert("[test_sortedList] Wrong lower bound",
+              sortedList->lowerBound(sortedList, &key) == 40);
+    mu_assert("[test_sortedList] Wrong upper bound",
+              sortedList->upperBound(sortedList, &key) == 44);
+    mu_assert("[test_sortedList] Wrong index returned by findSorted",
+              sortedList->findSorted(sortedList, &key) == 40);
+
+    int low  = 20;
+    int high = 22;
+    CD9List *range = sortedList->range(sortedList, &low, &high);
+
+    mu_assert("[test_sortedList] The range has the wrong length",
+              range->length == 12);
+    CD9FOREACH(range, value, index) {
+        mu_assert("[test_sortedList] The range has the wrong elements",
+                  *(int *)value == 20 + (int)index / 4);
+    }
+    cd9list_deleteList(range);
+
+    for(int i = 0; i < 4; i++) {
+        mu_assert("[test_sortedList] The element was not removed",
+                  sortedList->removeSorted(sortedList, &key) == 1);
+    }
+
+    mu_assert("[test_sortedList] Removed an element that doesn't exist",
+              sortedList->removeSorted(sortedList, &key) == 0);
+    mu_assert("[test_sortedList] Found an element that doesn't exist",
+              sortedList->findSorted(sortedList, &key) == -1);
+    mu_assert("[test_sortedList] Wrong index after removal",
+              sortedList->lowerBound(sortedList, &high) == 84);
+    mu_assert("[test_sortedList] Get is wrong after removal",
+              *(int *)sortedList->get(sortedList, 195) == 49);
+
+    cd9sortedlist_deleteList(sortedList);
+
+    return 0;
+}
+
+static char *test_arenaList()
+{
+    const char *data[] = {"foo", "bar", "baz"};
+    CD9List *list      = cd9list_createArenaList(64);
+
+    mu_assert("[test_arenaList] The arena was not created", 
+              list != NULL && list->arena != NULL);
+
+    for(int i = 0; i < 100; i++) {
+        list->appendCopy(list, data[i % 3], 4);
+    }
+
+    mu_assert("[test_arenaList] The length was not set properly",
+              list->length == 100);
+
+    list->remove(list, 0);
+    list->append(list, data[0]);
+
+    CD9FOREACH(list, value, index) {
+        if(index < 99) {
+            mu_assert("[test_arenaList] The copies were not stored properly",
+                      !strcmp(value, data[(index + 1) % 3]));
+        }
+        else {
+            mu_assert("[test_arenaList] The reference was not stored properly",
+                      value == data[0]);
+        }
+    }
+
+    // Lists derived from an arena list share its arena.
+    CD9List *copyList = list->copy(list);
+    mu_assert("[test_arenaList] The copy doesn't share the arena",
+              copyList->arena == list->arena && list->arena->refs == 2);
+
+    cd9list_deleteList(list);
+
+    mu_assert("[test_arenaList] The copy is wrong after deleting the source",
+              !strcmp(copyList->get(copyList, 0), data[1]));
+
+    cd9list_deleteList(copyList);
+
+    // An arena supplied by the caller can back more than one list.
+    CD9Arena *arena = cd9arena_create(0);
+    CD9List *first  = cd9list_createListOnArena(arena);
+    CD9List *second = cd9list_createListOnArena(arena);
+
+    cd9arena_release(arena);
+    first->appendCopy(first, data[0], 4);
+    second->appendCopy(second, data[1], 4);
+
+    mu_assert("[test_arenaList] The lists don't share the arena",
+              first->arena == second->arena && arena->refs == 2);
+
+    cd9list_deleteList(first);
+    cd9list_deleteList(second);
+
+    return 0;
+}
+
+typedef struct TestAllocatorStats {
+    size_t allocs;
+    size_t frees;
+    size_t bytes;
+} TestAllocatorStats;
+
+static void *test_allocator_alloc(void *ctx, size_t size)
+{
+    TestAllocatorStats *stats = ctx;
+
+    stats->allocs++;
+    stats->bytes += size;
+
+    return malloc(size);
+}
+
+static void test_allocator_free(void *ctx, void *memory, size_t size)
+{
+    TestAllocatorStats *stats = ctx;
+
+    stats->frees++;
+    stats->bytes -= size;
+
+    free(memory);
+}
+
+static char *test_allocator()
+{
+    const char *data[]       = {"foo", "bar", "baz"};
+    TestAllocatorStats stats = {0, 0, 0};
+    CD9Allocator allocator   = {
+        test_allocator_alloc, test_allocator_free, &stats
+    };
+
+    CD9List *list = cd9list_createListWithAllocator(&allocator);
+
+    for(int i = 0; i < 3; i++) {
+        list->appendCopy(list, data[i], 4);
+        list->append(list, data[i]);
+    }
+
+    // The list itself, 6 nodes and 3 copies.
+    mu_assert("[test_allocator] Not every allocation used the allocator",
+              stats.allocs == 10);
+
+    CD9List *filtered = list->filterByValue(list, data[0]);
+    CD9List *sliced   = list->slice(list, 0, 2, 1);
+    CD9List *result   = cd9list_concat(filtered, sliced);
+
+    mu_assert("[test_allocator] The derived lists don't use the allocator",
+              filtered->allocator.ctx == &stats && 
+              result->allocator.ctx == &stats);
+
+    list->remove(list, 0);
+
+    cd9list_deleteList(result);
+    cd9list_deleteList(sliced);
+    cd9list_deleteList(filtered);
+    cd9list_deleteList(list);
+
+    mu_assert("[test_allocator] Not every block was freed",
+              stats.allocs == stats.frees && stats.bytes == 0);
+
+    return 0;
+}
+
+#ifdef CD9LIST_STATS
+static char *test_stats()
+{
+    const int data[] = {3, 1, 2};
+    CD9List *list    = cd9list_createList();
+
+    for(int i = 0; i < 3; i++) {
+        list->appendCopy(list, &data[i], sizeof(int));
+    }
+
+    const CD9ListStats *stats = cd9list_getStats(list);
+
+    mu_assert("[test_stats] The appends were not counted",
+              stats->operations[CD9LIST_OP_APPEND] == 3);
+
+    list->get(list, 2);
+    mu_assert("[test_stats] The visited nodes were not counted",
+              stats->operations[CD9LIST_OP_GET] == 1 &&
+              stats->nodesVisited >= 3);
+
+    list->findByValue(list, &data[1]);
+    mu_assert("[test_stats] The callbacks were not counted",
+              stats->operations[CD9LIST_OP_FIND] == 1 &&
+              stats->callbacks == 2);
+
+    list->sort(list, test_sort_int_cmp);
+    mu_assert("[test_stats] The comparisons were not counted",
+              stats->operations[CD9LIST_OP_SORT] == 1 &&
+              stats->comparisons > 0);
+
+    mu_assert("[test_stats] The allocations were not counted",
+              stats->bytesAllocated == sizeof(CD9List) + 
+              3 * (sizeof(CD9Node) + sizeof(int)));
+
+    list->remove(list, 0);
+    mu_assert("[test_stats] The frees were not counted",
+              stats->bytesFreed == sizeof(CD9Node) + sizeof(int));
+
+    mu_assert("[test_stats] The global stats were not updated",
+              cd9list_getGlobalStats()->operations[CD9LIST_OP_SORT] > 0);
+
+    cd9list_deleteList(list);
+
+    return 0;
+}
+#endif
+
+static char *test_serialize()
+{
+    const char *data[] = {"foo", "a longer string", "baz"};
+    CD9List *list      = cd9list_createList();
+
+    for(int i = 0; i < 300; i++) {
+        list->appendCopy(list, data[i % 3], strlen(data[i % 3]) + 1);
+    }
+
+    FILE *file = tmpfile();
+    mu_assert("[test_serialize] The list was not written to the file",
+              cd9list_serialize(list, file) == 1);
+
+    rewind(file);
+    CD9List *fromFile = cd9list_deserialize(file);
+    fclose(file);
+
+    size_t size   = cd9list_serializedSize(list);
+    void *buffer  = malloc(size);
+    mu_assert("[test_serialize] The list was not written to the buffer",
+              cd9list_serializeToBuffer(list, buffer, size) == size);
+    mu_assert("[test_serialize] A buffer too small was accepted",
+              cd9list_serializeToBuffer(list, buffer, size - 1) == 0);
+
+    CD9List *fromBuffer = cd9list_deserializeFromBuffer(buffer, size);
+    mu_assert("[test_serialize] A truncated buffer was accepted",
+              cd9list_deserializeFromBuffer(buffer, size - 1) == NULL);
+    free(buffer);
+
+    mu_assert("[test_serialize] The lists were not read",
+              fromFile != NULL && fromBuffer != NULL);
+    mu_assert("[test_serialize] The lengths are wrong",
+              fromFile->length == 300 && fromBuffer->length == 300);
+    mu_assert("[test_serialize] The list was not read in a single block",
+              fromFile->arena->blocks->next == NULL);
+
+    CD9FOREACH(list, value, index) {
+        mu_assert("[test_serialize] The elements read from the file are wrong",
+                  !strcmp(fromFile->get(fromFile, index), value));
+        mu_assert("[test_serialize] The elements read from the buffer are "
+                  "wrong", !strcmp(fromBuffer->get(fromBuffer, index), value));
+    }
+
+    // A header that claims more than the input holds is rejected before
+    // anything big is allocated.
+    unsigned char header[CD9SERIALIZE_HEADER_SIZE] = "CD9L\1";
+    unsigned char element[] = {0x80, 0x80, 0x80, 0x80, 0x04, 'x'};
+    header[8]  = 1;    // One element...
+    header[21] = 0x01; // ...of 2^40 bytes.
+
+    mu_assert("[test_serialize] A buffer with a forged header was accepted",
+              cd9list_deserializeFromBuffer(header, sizeof(header)) == NULL);
+
+    // The element claims 2^30 bytes, but the file ends after one byte.
+    file = tmpfile();
+    fwrite(header, 1, sizeof(header), file);
+    fwrite(element, 1, sizeof(element), file);
+    rewind(file);
+
+    mu_assert("[test_serialize] A file with a forged header was accepted",
+              cd9list_deserialize(file) == NULL);
+    fclose(file);
+
+    // The lists of addresses can't be serialized.
+    CD9List *references = cd9list_createList();
+    references->append(references, data[0]);
+    mu_assert("[test_serialize] A list of addresses was serialized",
+              cd9list_serializedSize(references) == 0);
+
+    cd9list_deleteList(references);
+    cd9list_deleteList(fromBuffer);
+    cd9list_deleteList(fromFile);
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+static char *test_persistentList()
+{
+    const char *path = "./cd9list_test_persistent.bin";
+    char value[32];
+
+    remove(path);
+
+    CD9PersistentList *plist = cd9persistentlist_open(path);
+    mu_assert("[test_persistentList] The list was not created", plist != NULL);
+
+    // Enough elements to make the file grow a few times.
+    for(int i = 0; i < 10000; i++) {
+        sprintf(value, "value %d", i);
+        mu_assert("[test_persistentList] The element was not appended",
+                  plist->append(plist, value, strlen(value) + 1) == 1);
+    }
+
+    mu_assert("[test_persistentList] The list was not synced",
+              plist->sync(plist) == 1);
+    cd9persistentlist_close(plist);
+
+    plist = cd9persistentlist_open(path);
+    mu_assert("[test_persistentList] The list was not reopened",
+              plist != NULL && plist->header->length == 10000);
+
+    int i = 0;
+    CD9PFOREACH(plist, node) {
+        sprintf(value, "value %d", i++);
+        mu_assert("[test_persistentList] The element is wrong after reopening",
+                  !strcmp((char *)node->data, value));
+    }
+
+    mu_assert("[test_persistentList] Find returned the wrong index",
+              plist->findByValue(plist, "value 9000") == 9000);
+
+    // Remove every element but the multiples of 100, then compact.
+    for(int i = 9999; i >= 0; i--) {
+        if(i % 100 != 0) {
+            plist->remove(plist, i);
+        }
+    }
+
+    size_t capacity = plist->capacity;
+    mu_assert("[test_persistentList] The list was not compacted",
+              plist->compact(plist) == 1 && plist->capacity < capacity);
+
+    plist->append(plist, "last", 5);
+    cd9persistentlist_close(plist);
+
+    plist = cd9persistentlist_open(path);
+    mu_assert("[test_persistentList] The length is wrong after compacting",
+              plist->header->length == 101);
+    mu_assert("[test_persistentList] The elements are wrong after compacting",
+              !strcmp(plist->get(plist, 99), "value 9900") &&
+              !strcmp(plist->get(plist, 100), "last"));
+
+    // A link back to the head makes a cycle, the walks stop anyway and
+    // compact ends the list there.
+    CD9PersistentNode *second = cd9persistentlist_next(plist,
+                                    cd9persistentlist_first(plist));
+    second->next = plist->header->head;
+
+    mu_assert("[test_persistentList] A cycle was walked forever",
+              plist->findByValue(plist, "value 9999") == -1 &&
+              plist->get(plist, 101) == NULL &&
+              plist->compact(plist) == 1 && plist->header->length == 2 &&
+              !strcmp(plist->get(plist, 1), "value 100") &&
+              plist->append(plist, "last", 5) == 1 &&
+              !strcmp(plist->get(plist, 2), "last"));
+
+    // A link that points outside of the file ends the list.
+    CD9PersistentNode *node = cd9persistentlist_first(plist);
+    node->next = plist->capacity + 8;
+
+    mu_assert("[test_persistentList] A corrupt link was followed",
+              plist->get(plist, 1) == NULL && plist->remove(plist, 1) == 0 &&
+              plist->compact(plist) == 1 && plist->header->length == 1);
+
+    // A head that points outside of the file is rejected.
+    plist->header->head = plist->capacity;
+    cd9persistentlist_close(plist);
+
+    mu_assert("[test_persistentList] A corrupt file was opened",
+              cd9persistentlist_open(path) == NULL);
+
+    // So is a file that ends in the middle of the header.
+    FILE *file = fopen(path, "wb");
+    fwrite(CD9PERSISTENTLIST_MAGIC, 1, 4, file);
+    fclose(file);
+
+    mu_assert("[test_persistentList] A truncated file was opened",
+              cd9persistentlist_open(path) == NULL);
+    remove(path);
+
+    return 0;
+}
+
+static void test_stream_sumSizes(void *accumulator, const void *item,
+                                 size_t size)
+{
+    *(size_t *)accumulator += size;
+}
+
+static bool test_stream_cmp(const void *item, const void *data, size_t size)
+{
+    return !strcmp(item, data);
+}
+
+static char *test_stream()
+{
+    char big[200];
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+
+    const char *data[] = {"foo", "a longer string", big};
+    CD9List *list      = cd9list_createList();
+    size_t total       = 0;
+
+    for(int i = 0; i < 300; i++) {
+        list->appendCopy(list, data[i % 3], strlen(data[i % 3]) + 1);
+        total += strlen(data[i % 3]) + 1;
+    }
+
+    FILE *file = tmpfile();
+    cd9list_serialize(list, file);
+
+    // The buffers are smaller than some elements, so the elements that span
+    // more than one buffer are checked as well.
+    for(int readAhead = 0; readAhead < 2; readAhead++) {
+        rewind(file);
+        CD9Stream *stream = cd9stream_open(file, 64, readAhead);
+        mu_assert("[test_stream] The stream was not opened",
+                  stream != NULL && stream->length == 300);
+
+        size_t count = 0;
+        CD9STREAM_FOREACH(stream, value, size) {
+            mu_assert("[test_stream] The elements are wrong",
+                      !strcmp(value, list->get(list, count)) &&
+                      size == strlen(value) + 1);
+            count++;
+        }
+        mu_assert("[test_stream] Not all the elements were read", count == 300);
+
+        void *value;
+        size_t size;
+        mu_assert("[test_stream] An element was read after the end",
+                  !cd9stream_next(stream, &value, &size));
+        cd9stream_close(stream);
+
+        rewind(file);
+        stream = cd9stream_open(file, 64, readAhead);
+        mu_assert("[test_stream] The element was not found",
+                  cd9stream_find(stream, big, test_stream_cmp) == 2);
+        cd9stream_close(stream);
+
+        rewind(file);
+        stream = cd9stream_open(file, 64, readAhead);
+        CD9List *filtered = cd9stream_filter(stream, "foo",
+                                             test_stream_cmp);
+        mu_assert("[test_stream] The list was not filtered",
+                  filtered->length == 200 &&
+                  !strcmp(filtered->get(filtered, 199), big));
+        cd9list_deleteList(filtered);
+        cd9stream_close(stream);
+
+        rewind(file);
+        stream    = cd9stream_open(file, 0, readAhead);
+        size_t sum = 0;
+        cd9stream_reduce(stream, test_stream_sumSizes, &sum);
+        mu_assert("[test_stream] The stream was not reduced", sum == total);
+        cd9stream_close(stream);
+
+        // A stream closed before the end stops the helper thread as well.
+        rewind(file);
+        stream = cd9stream_open(file, 64, readAhead);
+        cd9stream_next(stream, &value, &size);
+        cd9stream_close(stream);
+    }
+
+    fclose(file);
+
+    // The values follow their sizes in the file, but they are handed out
+    // aligned, so they can be read as ints.
+    CD9List *numbers = cd9list_createList();
+
+    for(int i = 0; i < 100; i++) {
+        numbers->appendCopy(numbers, &i, sizeof(int));
+    }
+
+    file = tmpfile();
+    cd9list_serialize(numbers, file);
+    rewind(file);
+
+    CD9Stream *stream = cd9stream_open(file, 64, false);
+    int sum           = 0;
+
+    CD9STREAM_FOREACH(stream, value, size) {
+        mu_assert("[test_stream] The value is not aligned",
+                  (uintptr_t)value % sizeof(int) == 0);
+        sum += *(int *)value;
+    }
+
+    mu_assert("[test_stream] The ints were not read", sum == 4950);
+    cd9stream_close(stream);
+    cd9list_deleteList(numbers);
+    fclose(file);
+
+    file = tmpfile();
+    fputs("not a list", file);
+    rewind(file);
+    mu_assert("[test_stream] A file that is not a list was opened",
+              cd9stream_open(file, 64, true) == NULL);
+    fclose(file);
+
+    // The sizes of a corrupted file are not trusted: a size bigger than the
+    // file is not allocated up front and a size of 0 is an error.
+    const unsigned char huge[] = {0xff, 0xff, 0xff, 0xff, 0x0f, 'x'};
+    unsigned char bytes[CD9SERIALIZE_HEADER_SIZE + 2];
+    CD9List *one = cd9list_createList();
+    void *value;
+    size_t size;
+
+    one->appendCopy(one, "x", 1);
+    cd9list_serializeToBuffer(one, bytes, sizeof(bytes));
+    cd9list_deleteList(one);
+
+    for(int corruption = 0; corruption < 2; corruption++) {
+        file = tmpfile();
+
+        if(corruption == 0) {
+            memset(bytes + 16, 0xff, 7);
+            fwrite(bytes, 1, CD9SERIALIZE_HEADER_SIZE, file);
+            fwrite(huge, 1, sizeof(huge), file);
+        }
+        else {
+            memset(bytes + 16, 0, 8);
+            bytes[16]                       = 1;
+            bytes[CD9SERIALIZE_HEADER_SIZE] = 0;
+            fwrite(bytes, 1, sizeof(bytes), file);
+        }
+
+        rewind(file);
+        stream = cd9stream_open(file, 64, false);
+        mu_assert("[test_stream] A corrupted size was accepted",
+                  stream != NULL && !cd9stream_next(stream, &value, &size));
+        cd9stream_close(stream);
+        fclose(file);
+    }
+
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+static char *test_simd()
+{
+    const size_t widths[] = {1, 2, 3, 4, 8, 16, 32};
+    const size_t count    = 1000;
+    unsigned char *data   = malloc(count * 32);
+    unsigned char key[32];
+    uint64_t bitmap[(1000 + 63) / 64];
+    uint32_t seed = 12345;
+
+    for(size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        size_t width = widths[w];
+
+        // Few different bytes, so there are partial matches as well.
+        for(size_t i = 0; i < count * width; i++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            data[i] = (seed % 8 == 0) ? 1 : 0;
+        }
+
+        memset(key, 0, width);
+        size_t expected = 0;
+        int first       = -1;
+
+        for(size_t i = 0; i < count; i++) {
+            if(!memcmp(data + i * width, key, width)) {
+                expected++;
+                first = (first == -1) ? (int)i : first;
+            }
+        }
+
+        mu_assert("[test_simd] The first match is wrong",
+                  cd9simd_find(data, count, width, key) == first);
+        mu_assert("[test_simd] The number of matches is wrong",
+                  cd9simd_match(data, count, width, key, bitmap) == expected);
+
+        for(size_t i = 0; i < count; i++) {
+            bool match = !memcmp(data + i * width, key, width);
+            mu_assert("[test_simd] The bitmap is wrong",
+                      ((bitmap[i / 64] >> (i % 64)) & 1) == match);
+        }
+    }
+
+    memset(key, 0xff, sizeof(key));
+    mu_assert("[test_simd] A missing key was found",
+              cd9simd_find(data, count, 8, key) == -1);
+    free(data);
+
+    // The lists gather the elements of the same size in batches.
+    CD9List *list = cd9list_createList();
+
+    for(int i = 0; i < 200; i++) {
+        int value = i % 50;
+        list->appendCopy(list, &value, sizeof(int));
+    }
+
+    int value = 49;
+    mu_assert("[test_simd] The element was not found in the list",
+              list->findByValue(list, &value) == 49);
+
+    CD9List *filtered = list->filterByValue(list, &value);
+    mu_assert("[test_simd] The list was not filtered",
+              filtered->length == 196 &&
+              *(int *)filtered->get(filtered, 49) == 0);
+
+    cd9list_deleteList(filtered);
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+static char *test_compact()
+{
+    const char *data[] = {"foo", "bar", "baz"};
+    CD9List *list      = cd9list_createList();
+
+    for(int i = 0; i < 100; i++) {
+        if(i % 10 == 0) {
+            list->append(list, data[0]);
+        }
+        else {
+            list->appendCopy(list, data[i % 3], 4);
+        }
+    }
+
+    list->remove(list, 1);
+    list->insert(list, 50, data[2]);
+
+    CD9List *expected = list->copy(list);
+
+    mu_assert("[test_compact] The list was not compacted",
+              cd9list_compact(list) == 1 && list->arena != NULL &&
+              list->arena->blocks->next == NULL);
+
+    CD9Node *prev = NULL;
+
+    CD9FOREACH_(list, node, index) {
+        mu_assert("[test_compact] The nodes are not in the order of the list",
+                  prev == NULL || (char *)node > (char *)prev);
+
+        if(node->size == SIZE_ZERO) {
+            mu_assert("[test_compact] The reference was changed",
+                      node->data == expected->get(expected, index));
+        }
+        else {
+            mu_assert("[test_compact] The copy was not moved properly",
+                      !strcmp(node->data, expected->get(expected, index)));
+        }
+
+        prev = node;
+    }
+
+    // The list still works, and an arena list can be compacted again.
+    list->appendCopy(list, data[1], 4);
+    mu_assert("[test_compact] The list was not compacted again",
+              cd9list_compact(list) == 1 && list->length == 101 &&
+              !strcmp(list->get(list, 100), data[1]));
+
+    cd9list_deleteList(expected);
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+/**
+ * @brief The expected content of a list used by `test_copyOnWrite`.
+ */
+typedef struct TestCowModel {
+    CD9List *list;
+    int values[512];
+    size_t length;
+} TestCowModel;
+
+static bool test_copyOnWrite_matches(TestCowModel *model)
+{
+    if(model->list->length != model->length) {
+        return false;
+    }
+
+    CD9FOREACH(model->list, value, index) {
+        if(*(int *)value != model->values[index]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static char *test_copyOnWrite_run(bool onArena, bool small)
+{
+    TestCowModel models[6];
+    uint32_t seed = 2463534242u;
+
+    for(int i = 0; i < 6; i++) {
+        models[i].list   = onArena ? cd9list_createArenaList(0) :
+                           small   ? cd9list_createSmallList() :
+                                     cd9list_createList();
+        models[i].length = 0;
+        cd9list_setCopyOnWrite(models[i].list, true);
+    }
+
+    for(int i = 0; i < 20; i++) {
+        models[0].list->appendCopy(models[0].list, &i, sizeof(int));
+        models[0].values[models[0].length++] = i;
+    }
+
+    for(int step = 0; step < 3000; step++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+
+        TestCowModel *model = &models[seed % 6];
+        TestCowModel *other = &models[(seed / 6) % 6];
+        CD9List *list       = model->list;
+        int value           = step;
+        size_t index        = (model->length != 0) ?
+                              (seed / 36) % model->length : 0;
+
+        switch((seed / 7) % 10) {
+        case 0: // Replace `other` by a copy of `model`.
+        case 1: // Replace `other` by the end of `model`.
+        case 2: { // Replace `other` by `model` followed by `other`.
+            if(other == model) {
+                break;
+            }
+
+            CD9List *result;
+            TestCowModel expected;
+
+            if((seed / 7) % 10 == 0) {
+                result = list->copy(list);
+                memcpy(expected.values, model->values,
+                       model->length * sizeof(int));
+                expected.length = model->length;
+            }
+            else if((seed / 7) % 10 == 1) {
+                result = list->slice(list, index, 0, 1);
+                expected.length = (model->length != 0) ?
+                                  model->length - index : 0;
+                memcpy(expected.values, model->values + index,
+                       expected.length * sizeof(int));
+            }
+            else {
+                if(model->length + other->length > 512) {
+                    break;
+                }
+
+                result = cd9list_concat(list, other->list);
+                memcpy(expected.values, model->values,
+                       model->length * sizeof(int));
+                memcpy(expected.values + model->length, other->values,
+                       other->length * sizeof(int));
+                expected.length = model->length + other->length;
+            }
+
+            cd9list_deleteList(other->list);
+            memcpy(other->values, expected.values,
+                   expected.length * sizeof(int));
+            other->length = expected.length;
+            other->list   = result;
+            break;
+        }
+        case 3:
+            if(model->length < 512) {
+                list->appendCopy(list, &value, sizeof(int));
+                model->values[model->length++] = value;
+            }
+            break;
+        case 4:
+            if(model->length < 512) {
+                list->prependCopy(list, &value, sizeof(int));
+                memmove(model->values + 1, model->values,
+                        model->length * sizeof(int));
+                model->values[0] = value;
+                model->length++;
+            }
+            break;
+        case 5:
+            if(model->length < 512) {
+                list->_insertCopy(list, index, &value, sizeof(int));
+                memmove(model->values + index + 1, model->values + index,
+                        (model->length - index) * sizeof(int));
+                model->values[index] = value;
+                model->length++;
+            }
+            break;
+        case 6:
+            if(model->length != 0) {
+                list->remove(list, index);
+                memmove(model->values + index, model->values + index + 1,
+                        (model->length - index - 1) * sizeof(int));
+                model->length--;
+            }
+            break;
+        case 7:
+            if(model->length != 0) {
+                free(list->popleft(list));
+                memmove(model->values, model->values + 1,
+                        (model->length - 1) * sizeof(int));
+                model->length--;
+            }
+            break;
+        case 8:
+            if(model->length != 0) {
+                free(list->pop(list));
+                model->length--;
+            }
+            break;
+        case 9:
+            if(model->length > 1) {
+                list->reverse(list);
+
+                for(size_t i = 0; i < model->length / 2; i++) {
+                    int tmp = model->values[i];
+                    model->values[i] = model->values[model->length - 1 - i];
+                    model->values[model->length - 1 - i] = tmp;
+                }
+            }
+            break;
+        }
+
+        for(int i = 0; i < 6; i++) {
+            mu_assert("[test_copyOnWrite] A list doesn't match its model",
+                      test_copyOnWrite_matches(&models[i]));
+        }
+    }
+
+    for(int i = 0; i < 6; i++) {
+        cd9list_deleteList(models[i].list);
+    }
+
+    return 0;
+}
+
+static char *test_copyOnWrite()
+{
+    CD9List *list = cd9list_createList();
+    cd9list_setCopyOnWrite(list, true);
+
+    for(int i = 0; i < 10; i++) {
+        list->appendCopy(list, &i, sizeof(int));
+    }
+
+    CD9List *copyList = list->copy(list);
+    CD9List *tail     = list->slice(list, 4, 0, 1);
+
+    mu_assert("[test_copyOnWrite] The copy doesn't share the nodes",
+              copyList->nodes == list->nodes && copyList->shared->refs == 3 &&
+              tail->nodes == cd9list_getNode(list, 4) && tail->length == 6);
+
+    // Changing the end of the copy gives it its own nodes.
+    int value = 10;
+    copyList->appendCopy(copyList, &value, sizeof(int));
+    mu_assert("[test_copyOnWrite] The shared nodes were changed",
+              list->length == 10 && copyList->length == 11 &&
+              copyList->shared == NULL && list->shared->refs == 2);
+
+    // The first element can change without copying.
+    list->prependCopy(list, &value, sizeof(int));
+    free(list->popleft(list));
+    free(list->popleft(list));
+    mu_assert("[test_copyOnWrite] The front was not changed in place",
+              list->shared != NULL && list->length == 9 &&
+              *(int *)list->get(list, 0) == 1);
+
+    // Compacting a list copies the shared nodes as well.
+    mu_assert("[test_copyOnWrite] The shared list was not compacted",
+              cd9list_compact(tail) == 1 && tail->shared == NULL &&
+              tail->length == 6 && *(int *)tail->get(tail, 5) == 9 &&
+              list->shared->refs == 1);
+
+    // A list that is not in copy-on-write mode is copied, not shared.
+    CD9List *plain  = cd9list_createList();
+    plain->appendCopy(plain, &value, sizeof(int));
+    CD9List *joined = cd9list_concat(list, plain);
+
+    mu_assert("[test_copyOnWrite] concat shared a list not in the mode",
+              plain->shared == NULL && joined->length == 10 &&
+              *(int *)joined->get(joined, 9) == 10 &&
+              joined->get(joined, 9) != plain->get(plain, 0));
+
+    cd9list_deleteList(joined);
+    cd9list_deleteList(plain);
+    cd9list_deleteList(tail);
+    cd9list_deleteList(copyList);
+    cd9list_deleteList(list);
+
+    char *message = test_copyOnWrite_run(false, false);
+    if(message != 0) {
+        return message;
+    }
+
+    return test_copyOnWrite_run(true, false);
+}
+
+static bool test_query_odd(const void *item, const void *data, size_t size)
+{
+    return *(const int *)item % 2 != 0;
+}
+
+static bool test_query_equal(const void *item, const void *data, size_t size)
+{
+    return *(const int *)item == *(const int *)data;
+}
+
+static const void *test_query_square(const void *item, size_t size,
+                                     void *context, size_t *mappedSize)
+{
+    int *result = context;
+
+    *result     = *(const int *)item * *(const int *)item;
+    *mappedSize = sizeof(int);
+
+    return result;
+}
+
+static bool test_query_count(const void *item, size_t size, void *context)
+{
+    (*(size_t *)context)++;
+
+    return true;
+}
+
+static char *test_query()
+{
+    CD9List *list = cd9list_createList();
+    CD9List *set  = cd9list_createList();
+
+    for(int i = 0; i < 100; i++) {
+        list->appendCopy(list, &i, sizeof(int));
+    }
+
+    int removed[] = {4, 10};
+    set->appendCopy(set, &removed[0], sizeof(int));
+    set->appendCopy(set, &removed[1], sizeof(int));
+
+    // Even numbers without 4 and 10 and 20, squared, from the 2nd on, one
+    // out of 2, at most 5: 6, 12, 16, 22, 26.
+    int excluded = 20;
+    int square;
+    CD9Query *query = cd9query_create(list);
+
+    query->filter(query, NULL, test_query_odd)
+         ->filterBySet(query, set)
+         ->filterByValue(query, &excluded)
+         ->skip(query, 2)
+         ->step(query, 2)
+         ->map(query, test_query_square, &square)
+         ->take(query, 5);
+
+    CD9List *result = query->collect(query);
+    int expected[]  = {6, 12, 16, 22, 26};
+
+    mu_assert("[test_query] The length of the result is wrong",
+              result != NULL && result->length == 5);
+
+    CD9FOREACH(result, value, index) {
+        mu_assert("[test_query] The result is wrong",
+                  *(int *)value == expected[index] * expected[index]);
+    }
+
+    int wanted = 16 * 16;
+    mu_assert("[test_query] The element was not found",
+              query->find(query, &wanted, test_query_equal) == 2);
+
+    wanted = 30 * 30;
+    mu_assert("[test_query] An element was found after take",
+              query->find(query, &wanted, test_query_equal) == -1);
+
+    size_t count = 0;
+    mu_assert("[test_query] The elements were not passed to the callback",
+              query->forEach(query, test_query_count, &count) == 5 &&
+              count == 5);
+
+    cd9list_deleteList(result);
+    cd9query_delete(query);
+
+    // Without stages the query walks the whole list.
+    query  = cd9query_create(list);
+    result = query->take(query, 1000)->collect(query);
+    mu_assert("[test_query] The list was not copied",
+              result->length == 100 && *(int *)result->get(result, 99) == 99);
+
+    cd9list_deleteList(result);
+    cd9query_delete(query);
+
+    cd9list_deleteList(set);
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+static size_t test_unique_hash(const void *data, size_t size)
+{
+    // Every string starting with the same letter collides.
+    return ((const char *)data)[0];
+}
+
+static bool test_unique_equal(const void *a, size_t sizeA,
+                              const void *b, size_t sizeB)
+{
+    return ((const char *)a)[0] == ((const char *)b)[0];
+}
+
+static char *test_unique()
+{
+    int values[] = {3, 1, 3, 2, 1, 1, 4, 2};
+    int expected[] = {3, 1, 2, 4};
+    const char *refs[] = {"foo", "bar"};
+    CD9List *list = cd9list_createList();
+
+    for(int i = 0; i < 8; i++) {
+        list->appendCopy(list, &values[i], sizeof(int));
+    }
+
+    // The references are compared by address, not by value.
+    list->append(list, refs[0]);
+    list->append(list, refs[1]);
+    list->append(list, refs[0]);
+
+    mu_assert("[test_unique] Wrong number of distinct elements",
+              cd9list_countDistinct(list, NULL, NULL) == 6);
+    mu_assert("[test_unique] Wrong number of removed elements",
+              cd9list_unique(list, NULL, NULL) == 5 && list->length == 6);
+
+    CD9FOREACH_(list, node, index) {
+        if(index < 4) {
+            mu_assert("[test_unique] The first occurrences were not kept",
+                      *(int *)node->data == expected[index]);
+        }
+        else {
+            mu_assert("[test_unique] The references were not kept",
+                      node->data == refs[index - 4]);
+        }
+    }
+
+    mu_assert("[test_unique] The unique list changed",
+              cd9list_unique(list, NULL, NULL) == 0 && list->length == 6);
+
+    cd9list_deleteList(list);
+
+    // Custom callbacks, with collisions.
+    const char *words[] = {"apple", "avocado", "banana", "blueberry", "cherry"};
+    list = cd9list_createList();
+
+    for(int i = 0; i < 5; i++) {
+        list->appendCopy(list, words[i], strlen(words[i]) + 1);
+    }
+
+    mu_assert("[test_unique] The callbacks were not used",
+              cd9list_countDistinct(list, test_unique_hash,
+                                    test_unique_equal) == 3 &&
+              cd9list_unique(list, test_unique_hash,
+                             test_unique_equal) == 2 &&
+              !strcmp(list->get(list, 0), "apple") &&
+              !strcmp(list->get(list, 1), "banana") &&
+              !strcmp(list->get(list, 2), "cherry"));
+
+    cd9list_deleteList(list);
+
+    // The shared nodes of a copy are not changed.
+    CD9List *source = cd9list_createList();
+
+    for(int i = 0; i < 8; i++) {
+        source->appendCopy(source, &values[i], sizeof(int));
+    }
+
+    cd9list_setCopyOnWrite(source, true);
+    list = source->copy(source);
+
+    mu_assert("[test_unique] The copy was not deduplicated",
+              cd9list_unique(list, NULL, NULL) == 4 && list->length == 4 &&
+              source->length == 8 && *(int *)source->get(source, 2) == 3);
+
+    cd9list_deleteList(list);
+    cd9list_deleteList(source);
+
+    return 0;
+}
+
+static char *test_mergeSorted()
+{
+    int values1[] = {1, 3, 3, 8};
+    int values2[] = {0, 3, 5, 9, 10};
+    int expected[] = {0, 1, 3, 3, 3, 5, 8, 9, 10};
+    CD9List *list1 = cd9list_createList();
+    CD9List *list2 = cd9list_createArenaList(0);
+
+    for(int i = 0; i < 4; i++) {
+        list1->appendCopy(list1, &values1[i], sizeof(int));
+    }
+
+    for(int i = 0; i < 5; i++) {
+        list2->appendCopy(list2, &values2[i], sizeof(int));
+    }
+
+    int *first = list1->get(list1, 1);
+
+    // The nodes of the arena list are copied.
+    mu_assert("[test_mergeSorted] The lists were not merged",
+              cd9list_mergeSorted(list1, list2, test_sort_int_cmp) == 1 &&
+              list1->length == 9 && list2->length == 0 &&
+              list2->nodes == NULL);
+
+    CD9FOREACH_(list1, node, index) {
+        mu_assert("[test_mergeSorted] The result is not sorted",
+                  *(int *)node->data == expected[index]);
+    }
+
+    // The nodes of the first list were not copied, and they come first
+    // when the elements are equal.
+    mu_assert("[test_mergeSorted] The merge is not stable",
+              list1->get(list1, 2) == first);
+
+    mu_assert("[test_mergeSorted] Merging an empty list failed",
+              cd9list_mergeSorted(list1, list2, test_sort_int_cmp) == 1 &&
+              list1->length == 9 &&
+              cd9list_mergeSorted(list2, list1, test_sort_int_cmp) == 1 &&
+              list2->length == 9 && list1->length == 0 &&
+              *(int *)list2->get(list2, 8) == 10);
+
+    cd9list_deleteList(list1);
+    cd9list_deleteList(list2);
+
+    // Merge k lists, some of them empty or shared.
+    CD9List *lists[5];
+    CD9List *source = cd9list_createList();
+
+    for(int i = 0; i < 5; i++) {
+        lists[i] = (i == 3) ? cd9list_createArenaList(0) :
+                              cd9list_createList();
+    }
+
+    for(int i = 0; i < 60; i++) {
+        CD9List *list = (i % 3 == 0) ? lists[0] :
+                        (i % 3 == 1) ? lists[3] : source;
+
+        list->appendCopy(list, &i, sizeof(int));
+    }
+
+    cd9list_setCopyOnWrite(source, true);
+    cd9list_deleteList(lists[4]);
+    lists[4] = source->copy(source);
+
+    mu_assert("[test_mergeSorted] The k lists were not merged",
+              cd9list_mergeK(lists, 5, test_sort_int_cmp) == 1 &&
+              lists[0]->length == 60 && lists[3]->length == 0 &&
+              lists[4]->length == 0 && source->length == 20);
+
+    CD9FOREACH_(lists[0], node, index) {
+        mu_assert("[test_mergeSorted] The k lists are not sorted",
+                  *(int *)node->data == (int)index);
+    }
+
+    mu_assert("[test_mergeSorted] The source of the shared nodes changed",
+              *(int *)source->get(source, 19) == 59);
+
+    for(int i = 0; i < 5; i++) {
+        cd9list_deleteList(lists[i]);
+    }
+
+    cd9list_deleteList(source);
+
+    return 0;
+}
+
+static int test_topK_keyCmp(const void *a, const void *b)
+{
+    // Only the first int is compared, the second one records the order.
+    return ((const int *)a)[0] - ((const int *)b)[0];
+}
+
+static char *test_topK()
+{
+    CD9List *list = cd9list_createList();
+
+    srand(7);
+
+    for(int i = 0; i < 200; i++) {
+        int entry[2] = {rand() % 50, i};
+
+        list->appendCopy(list, entry, sizeof(entry));
+    }
+
+    CD9List *sorted = list->copy(list);
+    sorted->sort(sorted, test_topK_keyCmp);
+
+    size_t counts[] = {0, 1, 10, 200, 500};
+
+    for(size_t c = 0; c < 5; c++) {
+        CD9List *top = cd9list_topK(list, counts[c], test_topK_keyCmp);
+
+        mu_assert("[test_topK] Wrong number of elements",
+                  top != NULL && top->length == ((counts[c] < 200) ?
+                                                 counts[c] : 200));
+
+        // The sort is stable as well, so the ties must match exactly.
+        CD9FOREACH_(top, node, index) {
+            int *expected = sorted->get(sorted, index);
+
+            mu_assert("[test_topK] The elements are not the smallest ones",
+                      !memcmp(node->data, expected, 2 * sizeof(int)));
+        }
+
+        cd9list_deleteList(top);
+    }
+
+    for(size_t n = 0; n < 200; n++) {
+        int *nth = cd9list_nthElement(list, n, test_topK_keyCmp);
+
+        mu_assert("[test_topK] Wrong nth element",
+                  nth != NULL &&
+                  nth[0] == ((int *)sorted->get(sorted, n))[0]);
+    }
+
+    mu_assert("[test_topK] The nth element is out of range",
+              cd9list_nthElement(list, 200, test_topK_keyCmp) == NULL);
+    mu_assert("[test_topK] The list was changed",
+              list->length == 200 && ((int *)list->get(list, 10))[1] == 10);
+
+    cd9list_deleteList(sorted);
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+static bool test_hashing_cmp(const void *data,
+                             const void *toFind,
+                             size_t     size)
+{
+    // Only the copies are compared.
+    return size != SIZE_ZERO && !memcmp(data, toFind, size);
+}
+
+static CD9PayloadHeader *test_hashing_header(const CD9Node *node)
+{
+    return &((CD9PayloadRoom *)node->data - 1)->header;
+}
+
+static char *test_hashing()
+{
+    char payloads[6][40];
+    CD9List *list = cd9list_createList();
+
+    for(int i = 0; i < 6; i++) {
+        memset(payloads[i], 'a' + i, sizeof(payloads[i]));
+        list->appendCopy(list, payloads[i], sizeof(payloads[i]));
+    }
+
+    // The hashes are kept with the copies, the nodes don't grow.
+    mu_assert("[test_hashing] The copies have a header before the mode is on",
+              !list->payloadHeaders &&
+              sizeof(CD9Node) == 2 * sizeof(void *) + sizeof(size_t));
+
+    char missing[40] = "missing";
+
+    mu_assert("[test_hashing] The mode was not turned on",
+              cd9list_setHashing(list, true) == 1 && list->payloadHeaders);
+    list->appendCopy(list, payloads[0], sizeof(payloads[0]));
+
+    mu_assert("[test_hashing] findByValue is wrong",
+              list->findByValue(list, payloads[3]) == 3 &&
+              list->findByValue(list, missing) == -1);
+
+    // A node whose hash doesn't match is not compared at all.
+    CD9Node *node            = cd9list_getNode(list, 3);
+    CD9PayloadHeader *header = test_hashing_header(node);
+    size_t hash              = header->hash;
+
+    header->hash = hash + 1;
+    mu_assert("[test_hashing] The hash was not compared first",
+              list->findByValue(list, payloads[3]) == -1);
+    header->hash = hash;
+
+    // A copy changed in place needs a new hash.
+    memset(node->data, 'z', sizeof(payloads[3]));
+    cd9list_setHashing(list, true);
+    memset(payloads[3], 'z', sizeof(payloads[3]));
+    mu_assert("[test_hashing] The hash was not computed again",
+              list->findByValue(list, payloads[3]) == 3);
+
+    list->append(list, payloads[1]);
+
+    CD9FOREACH_(list, item) {
+        mu_assert("[test_hashing] The copies don't have a hash",
+                  item->size == SIZE_ZERO ||
+                  test_hashing_header(item)->hash != 0);
+    }
+
+    CD9List *filtered = list->filterByValue(list, payloads[0]);
+    mu_assert("[test_hashing] filterByValue is wrong",
+              filtered->length == 6 && filtered->hashing &&
+              test_hashing_header(filtered->nodes)->hash != 0 &&
+              memcmp(filtered->nodes->data, payloads[0], 40) != 0);
+
+    CD9List *set = cd9list_createList();
+
+    cd9list_setHashing(set, true);
+    set->appendCopy(set, payloads[1], sizeof(payloads[1]));
+    set->appendCopy(set, payloads[3], sizeof(payloads[3]));
+
+    CD9List *rest = list->filterBySet(list, set);
+    mu_assert("[test_hashing] filterBySet is wrong",
+              rest->length == 6 &&
+              rest->find(rest, payloads[3], test_hashing_cmp) == -1 &&
+              rest->findByAddress(rest, payloads[1]) == 5);
+
+    // The lists are compared whether they store hashes or not.
+    CD9List *copy  = list->copy(list);
+    CD9List *plain = cd9list_createList();
+
+    CD9FOREACH_(list, item) {
+        if(item->size == SIZE_ZERO) {
+            plain->append(plain, item->data);
+        }
+        else {
+            plain->appendCopy(plain, item->data, item->size);
+        }
+    }
+
+    mu_assert("[test_hashing] Equal lists are not equal",
+              cd9list_equals(list, copy) && cd9list_equals(list, plain) &&
+              cd9list_equals(plain, list));
+
+    plain->remove(plain, 7);
+    plain->append(plain, payloads[2]);
+    copy->remove(copy, 0);
+    mu_assert("[test_hashing] Different lists are equal",
+              !cd9list_equals(list, plain) && !cd9list_equals(list, copy) &&
+              !cd9list_equals(list, filtered));
+
+    // The packed copies are moved after a header too.
+    CD9List *records = cd9list_createListOfSize(sizeof(payloads[0]));
+
+    for(int i = 0; i < 6; i++) {
+        records->appendCopy(records, payloads[i], sizeof(payloads[i]));
+    }
+
+    mu_assert("[test_hashing] The packed copies don't have a hash",
+              cd9list_setHashing(records, true) == 1 &&
+              records->findByValue(records, payloads[4]) == 4 &&
+              test_hashing_header(cd9list_getNode(records, 4))->hash != 0);
+
+    cd9list_deleteList(records);
+    cd9list_deleteList(plain);
+    cd9list_deleteList(copy);
+    cd9list_deleteList(rest);
+    cd9list_deleteList(set);
+    cd9list_deleteList(filtered);
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+static char *test_removeIndices()
+{
+    int values[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    size_t indices[] = {7, 0, 3, 7, 42, 9};
+    int expected[] = {1, 2, 4, 5, 6, 8};
+    void *removed[6];
+    CD9List *list = cd9list_createList();
+
+    for(int i = 0; i < 10; i++) {
+        if(i == 3) {
+            list->append(list, &values[i]);
+        }
+        else {
+            list->appendCopy(list, &values[i], sizeof(int));
+        }
+    }
+
+    mu_assert("[test_removeIndices] Wrong number of removed elements",
+              cd9list_removeIndices(list, indices, 6, removed) == 4 &&
+              list->length == 6);
+
+    CD9FOREACH(list, value, index) {
+        mu_assert("[test_removeIndices] The wrong elements were removed",
+                  *(int *)value == expected[index]);
+    }
+
+    // The data comes back in the order of the list, the references as
+    // they were stored.
+    mu_assert("[test_removeIndices] The removed data is wrong",
+              *(int *)removed[0] == 0 && removed[1] == &values[3] &&
+              *(int *)removed[2] == 7 && *(int *)removed[3] == 9);
+
+    free(removed[0]);
+    free(removed[2]);
+    free(removed[3]);
+
+    CD9Node *nodes[] = {
+        cd9list_getNode(list, 5), NULL, cd9list_getNode(list, 1),
+        cd9list_getNode(list, 5)
+    };
+
+    mu_assert("[test_removeIndices] The nodes were not removed",
+              cd9list_removeNodes(list, nodes, 4, NULL) == 2 &&
+              list->length == 4 && *(int *)list->get(list, 1) == 4 &&
+              *(int *)list->get(list, 3) == 6);
+
+    // The shared nodes are copied before they are removed, the other list
+    // keeps them.
+    cd9list_setCopyOnWrite(list, true);
+    CD9List *copy = list->copy(list);
+    size_t first  = 0;
+
+    copy->prependCopy(copy, &values[9], sizeof(int));
+    mu_assert("[test_removeIndices] The own nodes were not removed in place",
+              cd9list_removeIndices(copy, &first, 1, NULL) == 1 &&
+              copy->shared != NULL && copy->ownLength == 0 &&
+              copy->length == 4);
+
+    CD9Node *last = cd9list_getNode(copy, 3);
+
+    mu_assert("[test_removeIndices] The shared nodes were not removed",
+              cd9list_removeNodes(copy, &last, 1, NULL) == 1 &&
+              cd9list_removeIndices(copy, &first, 1, NULL) == 1 &&
+              copy->length == 2 && *(int *)copy->get(copy, 0) == 4 &&
+              *(int *)copy->get(copy, 1) == 5 && list->length == 4 &&
+              *(int *)list->get(list, 3) == 6);
+
+    cd9list_deleteList(copy);
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+static char *test_splitAt()
+{
+    CD9List *list = cd9list_createList();
+
+    for(int i = 0; i < 10; i++) {
+        list->appendCopy(list, &i, sizeof(int));
+    }
+
+    void *fourth  = list->get(list, 4);
+    CD9List *tail = cd9list_splitAt(list, 4);
+
+    mu_assert("[test_splitAt] The list was not split",
+              tail != NULL && list->length == 4 && tail->length == 6 &&
+              tail->get(tail, 0) == fourth &&
+              *(int *)list->get(list, 3) == 3 &&
+              cd9list_getNode(list, 3)->next == NULL);
+
+    CD9List *empty = cd9list_splitAt(list, 4);
+
+    mu_assert("[test_splitAt] Splitting at the end is wrong",
+              empty != NULL && empty->length == 0 && list->length == 4);
+
+    cd9list_deleteList(empty);
+
+    // 4 5 6 7 8 9 -> 6 7 8 9 4 5, without moving the data.
+    mu_assert("[test_splitAt] The list was not rotated",
+              cd9list_rotate(tail, 8) == 1 && tail->length == 6 &&
+              *(int *)tail->get(tail, 0) == 6 && tail->get(tail, 4) == fourth &&
+              *(int *)tail->get(tail, 5) == 5 &&
+              cd9list_getNode(tail, 5)->next == NULL);
+
+    mu_assert("[test_splitAt] A full rotation changed the list",
+              cd9list_rotate(tail, 12) == 1 && tail->get(tail, 4) == fourth);
+
+    // The shared nodes go to the new list without being copied.
+    cd9list_setCopyOnWrite(tail, true);
+    CD9List *copy = tail->copy(tail);
+
+    copy->prependCopy(copy, &(int){42}, sizeof(int));
+
+    CD9List *rest = cd9list_splitAt(copy, 1);
+
+    mu_assert("[test_splitAt] The shared nodes were copied",
+              rest != NULL && rest->get(rest, 4) == fourth &&
+              copy->length == 1 && copy->shared == NULL &&
+              *(int *)copy->get(copy, 0) == 42);
+
+    CD9List *end = cd9list_splitAt(rest, 3);
+
+    mu_assert("[test_splitAt] The shared nodes were not split",
+              end != NULL && rest->length == 3 && end->length == 3 &&
+              *(int *)end->get(end, 0) == 9 && tail->length == 6 &&
+              *(int *)tail->get(tail, 3) == 9);
+
+    // The copies made by unsharing a small list don't stay inside it.
+    CD9List *small = cd9list_createSmallList();
+
+    cd9list_setCopyOnWrite(small, true);
+    for(int i = 0; i < 3; i++) {
+        small->appendCopy(small, &i, sizeof(int));
+    }
+
+    CD9List *shared = small->copy(small);
+    CD9List *moved  = cd9list_splitAt(small, 1);
+
+    cd9list_deleteList(small);
+
+    mu_assert("[test_splitAt] The small list was not split",
+              moved != NULL && moved->length == 2 &&
+              *(int *)moved->get(moved, 0) == 1 &&
+              *(int *)moved->get(moved, 1) == 2 &&
+              *(int *)shared->get(shared, 2) == 2);
+
+    cd9list_deleteList(moved);
+    cd9list_deleteList(shared);
+    cd9list_deleteList(end);
+    cd9list_deleteList(rest);
+    cd9list_deleteList(copy);
+    cd9list_deleteList(tail);
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+static char *test_owned()
+{
+    CD9List *list = cd9list_createList();
+    int value     = 7;
+
+    for(int i = 0; i < 3; i++) {
+        int *buffer = malloc(sizeof(int));
+
+        *buffer = i;
+        mu_assert("[test_owned] The buffer was not adopted",
+                  cd9list_appendOwned(list, buffer, sizeof(int)) == 1 &&
+                  list->get(list, i) == buffer);
+    }
+
+    int *first = malloc(sizeof(int));
+    *first     = -1;
+
+    mu_assert("[test_owned] The buffer was not prepended",
+              cd9list_prependOwned(list, first, sizeof(int)) == 1 &&
+              list->get(list, 0) == first && list->length == 4 &&
+              cd9list_appendOwned(list, &value, 0) == 0);
+
+    list->append(list, &value);
+
+    size_t size;
+    int *item = cd9list_popleftOwned(list, &size);
+
+    mu_assert("[test_owned] popleftOwned copied the data",
+              item == first && size == sizeof(int) && list->length == 4);
+    free(item);
+
+    mu_assert("[test_owned] popOwned is wrong for references",
+              cd9list_popOwned(list, &size) == &value && size == 0);
+
+    void *last = list->get(list, 2);
+    item       = cd9list_popOwned(list, NULL);
+
+    mu_assert("[test_owned] popOwned copied the data",
+              item == last && *item == 2 && list->length == 2);
+    free(item);
+
+    // The shared nodes stay with the copy, the caller gets its own data.
+    cd9list_setCopyOnWrite(list, true);
+    CD9List *copy = list->copy(list);
+
+    item = cd9list_popleftOwned(copy, NULL);
+    mu_assert("[test_owned] The shared data was handed over",
+              *item == 0 && item != list->get(list, 0) &&
+              *(int *)list->get(list, 0) == 0 && copy->length == 1);
+    free(item);
+
+    item = cd9list_popOwned(copy, NULL);
+    mu_assert("[test_owned] The last shared element is wrong",
+              *item == 1 && copy->length == 0 &&
+              cd9list_popOwned(copy, NULL) == NULL &&
+              cd9list_popleftOwned(copy, NULL) == NULL);
+    free(item);
+
+    // Only the shared nodes before the last one are copied.
+    CD9List *queue = cd9list_createList();
+
+    cd9list_setCopyOnWrite(queue, true);
+    for(int i = 0; i < 4; i++) {
+        queue->appendCopy(queue, &i, sizeof(int));
+    }
+
+    CD9List *tail  = queue->slice(queue, 1, 0, 1);
+    CD9Node *third = cd9list_getNode(queue, 3);
+
+    mu_assert("[test_owned] The slice doesn't share the nodes",
+              tail->shared != NULL && cd9list_getNode(tail, 2) == third);
+
+    item = cd9list_popOwned(tail, &size);
+    mu_assert("[test_owned] popOwned is wrong for a shared list",
+              *item == 3 && item != third->data && size == sizeof(int) &&
+              tail->length == 2 && tail->shared == NULL &&
+              *(int *)tail->get(tail, 1) == 2 &&
+              queue->length == 4 && cd9list_getNode(queue, 3) == third);
+    free(item);
+
+    // The last list that shares the nodes takes them as they are.
+    CD9List *rest = queue->slice(queue, 1, 0, 1);
+    void *data    = third->data;
+
+    cd9list_deleteList(queue);
+    mu_assert("[test_owned] The slice doesn't share the nodes",
+              rest->shared != NULL && rest->shared->refs == 1 &&
+              rest->shared->nodes != rest->sharedNodes);
+
+    item = cd9list_popOwned(rest, NULL);
+    mu_assert("[test_owned] popOwned copied the data of a shared list",
+              item == data && rest->length == 2 && rest->shared == NULL &&
+              *(int *)rest->get(rest, 0) == 1);
+    free(item);
+
+    cd9list_deleteList(rest);
+    cd9list_deleteList(tail);
+
+    // An arena list keeps a copy of the buffer.
+    CD9List *arenaList = cd9list_createArenaList(0);
+    int *buffer        = malloc(sizeof(int));
+
+    *buffer = 5;
+    mu_assert("[test_owned] The arena list didn't copy the buffer",
+              cd9list_appendOwned(arenaList, buffer, sizeof(int)) == 1 &&
+              *(int *)arenaList->get(arenaList, 0) == 5);
+
+    item = cd9list_popOwned(arenaList, NULL);
+    mu_assert("[test_owned] The arena list didn't return a copy",
+              *item == 5 && arenaList->length == 0);
+    free(item);
+
+    cd9list_deleteList(arenaList);
+    cd9list_deleteList(copy);
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+static bool test_smallList_cmp(const void *data,
+                               const void *toFind,
+                               size_t     size)
+{
+    return size == sizeof(int) && *(const int *)data == *(const int *)toFind;
+}
+
+static char *test_smallList()
+{
+    CD9List *list = cd9list_createSmallList();
+    char big[32]  = "too big to be kept inline";
+    int values[6] = {0, 1, 2, 3, 4, 5};
+
+    list->appendCopy(list, &values[0], sizeof(int));
+    list->append(list, &values[1]);
+    list->appendCopy(list, big, sizeof(big));
+    list->appendCopy(list, &values[2], sizeof(int));
+    list->appendCopy(list, &values[3], sizeof(int));
+    list->appendCopy(list, &values[4], sizeof(int));
+
+    mu_assert("[test_smallList] The first elements are not inline",
+              list->inlineSlots->used == 0xf &&
+              cd9list_getNode(list, 0) == &list->inlineSlots->nodes[0] &&
+              cd9list_getNode(list, 2) != &list->inlineSlots->nodes[2] &&
+              cd9list_getNode(list, 5) != &list->inlineSlots->nodes[3]);
+
+    mu_assert("[test_smallList] The list doesn't work like the others",
+              *(int *)list->get(list, 0) == 0 &&
+              list->get(list, 1) == &values[1] &&
+              !strcmp(list->get(list, 2), big) &&
+              list->find(list, &values[4], test_smallList_cmp) == 5 &&
+              list->findByAddress(list, &values[1]) == 1);
+
+    // A removed element gives its slot back.
+    list->remove(list, 0);
+    list->prependCopy(list, &values[5], sizeof(int));
+
+    mu_assert("[test_smallList] The slot was not reused",
+              list->nodes == &list->inlineSlots->nodes[0] &&
+              *(int *)list->get(list, 0) == 5);
+
+    size_t size;
+    int *item = cd9list_popleftOwned(list, &size);
+
+    mu_assert("[test_smallList] The inline copy was handed over",
+              item != NULL && *item == 5 && size == sizeof(int) &&
+              (list->inlineSlots->used & 1) == 0);
+    free(item);
+
+    // The nodes that leave the list don't stay inside it.
+    CD9List *tail = cd9list_splitAt(list, 2);
+
+    mu_assert("[test_smallList] The split nodes are still inline",
+              tail != NULL && tail->length == 3 && list->length == 2 &&
+              list->inlineSlots->used == 0 &&
+              *(int *)tail->get(tail, 1) == 3);
+
+    CD9List *copy = tail->copy(tail);
+
+    mu_assert("[test_smallList] The copy is not small",
+              copy->inlineSlots != NULL && cd9list_equals(copy, tail) &&
+              copy->inlineSlots->used == 0x7);
+
+    // The merged nodes outlive the small list.
+    CD9List *merged = cd9list_createList();
+
+    merged->appendCopy(merged, &values[3], sizeof(int));
+    mu_assert("[test_smallList] The small list was not merged",
+              cd9list_mergeSorted(merged, copy, test_sort_int_cmp) == 1 &&
+              copy->inlineSlots->used == 0);
+
+    cd9list_deleteList(copy);
+    mu_assert("[test_smallList] The merged list is wrong",
+              merged->length == 4 && *(int *)merged->get(merged, 0) == 2 &&
+              *(int *)merged->get(merged, 3) == 4);
+
+    cd9list_deleteList(merged);
+    cd9list_deleteList(tail);
+    cd9list_deleteList(list);
+
+    // Every operation still works with copy-on-write.
+    return test_copyOnWrite_run(false, true);
+}
+
+static void test_batched_cmp(const void *const *items,
+                             const size_t      *sizes,
+                             size_t            n,
+                             const void        *key,
+                             uint8_t           *matches)
+{
+    for(size_t i = 0; i < n; i++) {
+        matches[i] = sizes[i] == sizeof(int) &&
+                     *(const int *)items[i] == *(const int *)key;
+    }
+}
+
+static char *test_batched()
+{
+    CD9List *list = cd9list_createList();
+    int key       = -1;
+    int missing   = -2;
+
+    // The list spans several batches, the matches are in the second one.
+    for(int i = 0; i < 200; i++) {
+        int value = (i == 100 || i == 101 || i == 150) ? key : i;
+
+        list->appendCopy(list, &value, sizeof(int));
+    }
+
+    list->append(list, &key);
+
+    mu_assert("[test_batched] findBatched is wrong",
+              cd9list_findBatched(list, &key, test_batched_cmp) == 100 &&
+              cd9list_findBatched(list, &missing, test_batched_cmp) == -1);
+
+    CD9List *filtered = cd9list_filterBatched(list, &key, test_batched_cmp);
+
+    mu_assert("[test_batched] filterBatched is wrong",
+              filtered->length == 198 &&
+              *(int *)filtered->get(filtered, 99) == 99 &&
+              *(int *)filtered->get(filtered, 100) == 102 &&
+              *(int *)filtered->get(filtered, 196) == 199 &&
+              filtered->get(filtered, 197) == &key);
+
+    CD9List *empty = cd9list_createList();
+    CD9List *none  = cd9list_filterBatched(empty, &key, test_batched_cmp);
+
+    mu_assert("[test_batched] The empty list is wrong",
+              cd9list_findBatched(empty, &key, test_batched_cmp) == -1 &&
+              none->length == 0);
+
+    cd9list_deleteList(none);
+    cd9list_deleteList(empty);
+    cd9list_deleteList(filtered);
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+static char *test_stringList_run(bool interning)
+{
+    CD9StringList *list = cd9stringlist_createList(interning);
+    const char *words[] = {"pear", "apple", "fig", "apple", "", "pear"};
+    char text[]         = "banana split";
+    char buffer[16];
+
+    for(size_t i = 0; i < 6; i++) {
+        list->append(list, words[i]);
+    }
+
+    list->appendLength(list, text, 6);
+
+    mu_assert("[test_stringList] The strings are wrong",
+              list->length == 7 && !strcmp(list->get(list, 1), "apple") &&
+              !strcmp(list->get(list, 6), "banana") &&
+              list->strings[6].length == 6 && list->get(list, 7) == NULL);
+
+    mu_assert("[test_stringList] find is wrong",
+              list->find(list, "apple") == 1 && list->find(list, "") == 4 &&
+              list->find(list, "banana") == 6 &&
+              list->find(list, "banana split") == -1 &&
+              list->find(list, "kiwi") == -1);
+
+    mu_assert("[test_stringList] Interning didn't share the strings",
+              (list->get(list, 1) == list->get(list, 3)) == interning);
+
+    CD9StringList *set = cd9stringlist_createList(false);
+    set->append(set, "pear");
+    set->append(set, "kiwi");
+
+    CD9StringList *filtered = list->filterBySet(list, set);
+
+    mu_assert("[test_stringList] filterBySet is wrong",
+              filtered->length == 5 &&
+              filtered->get(filtered, 0) == list->get(list, 1) &&
+              filtered->find(filtered, "pear") == -1 &&
+              filtered->find(filtered, "fig") == 1);
+
+    mu_assert("[test_stringList] unique is wrong",
+              list->unique(list) == 2 && list->length == 5 &&
+              !strcmp(list->get(list, 3), "") &&
+              !strcmp(list->get(list, 4), "banana"));
+
+    list->sort(list);
+
+    mu_assert("[test_stringList] sort is wrong",
+              !strcmp(list->get(list, 0), "") &&
+              !strcmp(list->get(list, 1), "apple") &&
+              !strcmp(list->get(list, 2), "banana") &&
+              !strcmp(list->get(list, 4), "pear"));
+
+    // The strings of the filtered list stay valid after the list is gone.
+    cd9stringlist_deleteList(list);
+
+    mu_assert("[test_stringList] The shared arena was released",
+              !strcmp(filtered->get(filtered, 0), "apple"));
+
+    // Enough strings to fill several chunks, and one that gets its own
+    // memory.
+    for(int i = 0; i < 5000; i++) {
+        sprintf(buffer, "word%d", i % 2500);
+        filtered->append(filtered, buffer);
+    }
+
+    char *large = malloc(CD9STRINGLIST_CHUNK_SIZE);
+    memset(large, 'x', CD9STRINGLIST_CHUNK_SIZE - 1);
+    large[CD9STRINGLIST_CHUNK_SIZE - 1] = '\0';
+    filtered->append(filtered, large);
+
+    mu_assert("[test_stringList] The big list is wrong",
+              filtered->length == 5006 &&
+              filtered->find(filtered, "word2499") == 2504 &&
+              filtered->find(filtered, large) == 5005 &&
+              filtered->unique(filtered) == 2501);
+
+    filtered->sort(filtered);
+
+    for(size_t i = 1; i < filtered->length; i++) {
+        mu_assert("[test_stringList] The big list is not sorted",
+                  strcmp(filtered->get(filtered, i - 1),
+                         filtered->get(filtered, i)) < 0);
+    }
+
+    free(large);
+    cd9stringlist_deleteList(filtered);
+    cd9stringlist_deleteList(set);
+
+    return 0;
+}
+
+static char *test_stringList()
+{
+    char *result = test_stringList_run(false);
+
+    if(result != NULL) {
+        return result;
+    }
+
+    return test_stringList_run(true);
+}
+
+typedef struct TestRecord {
+    int64_t key;
+    int64_t value;
+} TestRecord;
+
+static int test_listOfSize_cmp(const void *a, const void *b)
+{
+    int64_t keyA = ((const TestRecord *)a)->key;
+    int64_t keyB = ((const TestRecord *)b)->key;
+
+    return (keyA > keyB) - (keyA < keyB);
+}
+
+static char *test_listOfSize()
+{
+    CD9List *list = cd9list_createListOfSize(sizeof(TestRecord));
+    int reference = 3;
+    int small     = 4;
+
+    for(int i = 0; i < 6; i++) {
+        TestRecord record = {5 - i, i * 10};
+
+        list->appendCopy(list, &record, sizeof(TestRecord));
+    }
+
+    CD9Node *node = cd9list_getNode(list, 2);
+
+    mu_assert("[test_listOfSize] The copy is not packed with its node",
+              node->data == (void *)((CD9PackedNode *)node + 1) &&
+              cd9list_nodeSize(list, node) == sizeof(TestRecord) &&
+              ((TestRecord *)list->get(list, 2))->value == 20);
+
+    // The list only holds copies of its element size.
+    int *owned = malloc(sizeof(int));
+
+    mu_assert("[test_listOfSize] The other elements were added",
+              list->append(list, &reference) == 0 &&
+              list->appendCopy(list, &small, sizeof(int)) == 0 &&
+              list->insert(list, 2, &reference) == 0 &&
+              list->length == 6 &&
+              cd9list_appendOwned(list, owned, sizeof(int)) == 0);
+    free(owned);
+
+    // The nodes don't have a size, the list tells it.
+    TestRecord *data = cd9list_copyNodeData(list, node);
+
+    mu_assert("[test_listOfSize] The packed copy was not copied",
+              data != NULL && data != node->data && data->value == 20);
+    free(data);
+
+    // The packed copies are handed over as copies of their own.
+    size_t size;
+    TestRecord *record = cd9list_popOwned(list, &size);
+
+    mu_assert("[test_listOfSize] popOwned is wrong",
+              size == sizeof(TestRecord) && record->key == 0 &&
+              record->value == 50 && list->length == 5);
+    free(record);
+
+    // The nodes are still packed in the arena.
+    mu_assert("[test_listOfSize] The list was not compacted",
+              cd9list_compact(list) == 1 && list->arena != NULL &&
+              ((TestRecord *)list->get(list, 4))->value == 40);
+
+    node = cd9list_getNode(list, 1);
+    mu_assert("[test_listOfSize] The copy is not packed after compacting",
+              node->data == (void *)((CD9PackedNode *)node + 1));
+
+    cd9list_setCopyOnWrite(list, true);
+    CD9List *copy = list->copy(list);
+
+    mu_assert("[test_listOfSize] The copy is not of the same size",
+              copy->elementSize == sizeof(TestRecord));
+
+    list->sort(list, test_listOfSize_cmp);
+
+    mu_assert("[test_listOfSize] The list is not sorted",
+              ((TestRecord *)list->get(list, 0))->key == 1 &&
+              ((TestRecord *)list->get(list, 4))->key == 5 &&
+              ((TestRecord *)copy->get(copy, 0))->key == 5);
+
+    CD9List *other = cd9list_createList();
+    TestRecord extra = {3, 99};
+    other->appendCopy(other, &extra, sizeof(TestRecord));
+
+    mu_assert("[test_listOfSize] mergeSorted is wrong",
+              cd9list_mergeSorted(other, list, test_listOfSize_cmp) == 1 &&
+              other->length == 6 && list->length == 0 &&
+              ((TestRecord *)other->get(other, 2))->value == 99);
+
+    cd9list_deleteList(copy);
+    cd9list_deleteList(other);
+    cd9list_deleteList(list);
+
+    return 0;
+}
+
+static bool test_refCounted_odd(const void *item,
+                                const void *data,
+                                size_t     size)
+{
+    return *(const int *)item % 2 == 1;
+}
+
+static char *test_refCounted()
+{
+    CD9List *list = cd9list_createRefCountedList();
+    int one       = 1;
+
+    for(int i = 0; i < 6; i++) {
+        list->appendCopy(list, &i, sizeof(int));
+    }
+
+    CD9List *copy  = list->copy(list);
+    CD9List *slice = list->slice(list, 1, 5, 2);
+    CD9List *even  = list->filter(list, NULL, test_refCounted_odd);
+
+    mu_assert("[test_refCounted] The copies are not shared",
+              copy->get(copy, 3) == list->get(list, 3) &&
+              slice->length == 2 &&
+              slice->get(slice, 1) == list->get(list, 3) &&
+              even->length == 3 && even->get(even, 2) == list->get(list, 4));
+
+    // The shared copies outlive the list they were made by.
+    cd9list_deleteList(list);
+
+    CD9List *both = cd9list_concat(slice, even);
+
+    mu_assert("[test_refCounted] concat is wrong",
+              both->length == 5 && both->get(both, 0) == slice->get(slice, 0) &&
+              both->get(both, 4) == even->get(even, 2) &&
+              *(int *)both->get(both, 4) == 4);
+
+    // The popped elements are copies of their own.
+    int *last = copy->pop(copy);
+
+    mu_assert("[test_refCounted] pop is wrong", *last == 5);
+    free(last);
+
+    size_t size;
+    int *owned = cd9list_popOwned(copy, &size);
+
+    mu_assert("[test_refCounted] popOwned is wrong",
+              *owned == 4 && size == sizeof(int) &&
+              owned != even->get(even, 2) && *(int *)even->get(even, 2) == 4);
+    free(owned);
+
+    // The copies made in copy-on-write mode are shared too.
+    cd9list_setCopyOnWrite(copy, true);
+    CD9List *view = copy->copy(copy);
+    view->prependCopy(view, &one, sizeof(int));
+
+    mu_assert("[test_refCounted] The copy-on-write copy is wrong",
+              view->length == 5 && view->get(view, 2) == copy->get(copy, 1) &&
+              *(int *)view->get(view, 0) == 1);
+
+    view->remove(view, 4);
+
+    mu_assert("[test_refCounted] The unshared view is wrong",
+              view->length == 4 && *(int *)view->get(view, 3) == 2 &&
+              view->get(view, 3) == copy->get(copy, 2) &&
+              view->get(view, 3) == both->get(both, 3));
+
+    // The copies moved to the arena are still shared.
+    CD9List *packed = copy->copy(copy);
+
+    mu_assert("[test_refCounted] The compacted copies are not shared",
+              cd9list_compact(copy) == 1 && copy->refCounted &&
+              *(int *)copy->get(copy, 1) == 1 &&
+              copy->get(copy, 1) != packed->get(packed, 1));
+
+    CD9List *after = copy->filter(copy, NULL, test_refCounted_odd);
+
+    mu_assert("[test_refCounted] The arena copies are not shared",
+              after->length == 2 &&
+              after->get(after, 1) == copy->get(copy, 2) &&
+              *(int *)after->get(after, 1) == 2);
+
+    cd9list_deleteList(after);
+    cd9list_deleteList(packed);
+    cd9list_deleteList(copy);
+    cd9list_deleteList(both);
+    cd9list_deleteList(slice);
+    cd9list_deleteList(even);
+    cd9list_deleteList(view);
+
+    return 0;
+}
+
 static char *all_tests() 
 {
     mu_run_test(test_createNode);
@@ -786,6 +2885,31 @@ static char *all_tests()
     mu_run_test(test_filter);
     mu_run_test(test_filterByValue);
     mu_run_test(test_filterBySet);
+    mu_run_test(test_sortedList);
+    mu_run_test(test_arenaList);
+    mu_run_test(test_allocator);
+#ifdef CD9LIST_STATS
+    mu_run_test(test_stats);
+#endif
+    mu_run_test(test_serialize);
+    mu_run_test(test_persistentList);
+    mu_run_test(test_stream);
+    mu_run_test(test_simd);
+    mu_run_test(test_compact);
+    mu_run_test(test_copyOnWrite);
+    mu_run_test(test_query);
+    mu_run_test(test_unique);
+    mu_run_test(test_mergeSorted);
+    mu_run_test(test_topK);
+    mu_run_test(test_hashing);
+    mu_run_test(test_removeIndices);
+    mu_run_test(test_splitAt);
+    mu_run_test(test_owned);
+    mu_run_test(test_smallList);
+    mu_run_test(test_batched);
+    mu_run_test(test_stringList);
+    mu_run_test(test_listOfSize);
+    mu_run_test(test_refCounted);
 
     return 0;
 }